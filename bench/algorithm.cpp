@@ -0,0 +1,167 @@
+/*
+	Copyright (c) 2012 Charly LERSTEAU
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/*
+	Benchmark of the shuffling and sampling algorithms of algorithm.hpp
+	against the standard library.
+
+	Build with:
+		g++ -std=c++11 -O2 -I../include algorithm.cpp -o algorithm
+*/
+
+#include <algorithm>
+#include <numeric>
+#include <random>
+#include <vector>
+#include "algorithm.hpp"
+#include "bench.hpp"
+
+// Classic reservoir sampling (algorithm R): one random draw per element.
+template<typename T, class G>
+void reservoir_r( const std::vector<T> & input, std::vector<T> & output, std::size_t k, G & g )
+{
+	output.assign( input.begin(), input.begin() + k );
+	for ( std::size_t i = k; i < input.size(); ++i )
+	{
+		const std::size_t j = std::uniform_int_distribution<std::size_t>( 0, i )( g );
+		if ( j < k ) output[j] = input[i];
+	}
+}
+
+void bench_shuffle( std::size_t n )
+{
+	const int iterations = int( 10000000 / n ) + 1;
+	std::vector<int> v( n );
+	std::iota( v.begin(), v.end(), 0 );
+
+	ot::mt19937  og;
+	std::mt19937 sg;
+
+	std::printf( "shuffle, n = %lu\n", (unsigned long) n );
+
+	const double ref = bench::measure( [&]
+	{
+		for ( int i = 0; i < iterations; ++i ) std::shuffle( v.begin(), v.end(), sg );
+		bench::keep( v[0] );
+	}, double( n ) * iterations );
+	bench::report( "  std::shuffle (std::mt19937)", ref );
+
+#if __cplusplus < 201703L
+	bench::report( "  std::random_shuffle (rand)", bench::measure( [&]
+	{
+		for ( int i = 0; i < iterations; ++i ) std::random_shuffle( v.begin(), v.end() );
+		bench::keep( v[0] );
+	}, double( n ) * iterations ), ref );
+#endif
+
+	bench::report( "  ot::shuffle (ot::mt19937)", bench::measure( [&]
+	{
+		for ( int i = 0; i < iterations; ++i ) ot::shuffle( v.begin(), v.end(), og );
+		bench::keep( v[0] );
+	}, double( n ) * iterations ), ref );
+
+	bench::report( "  ot::shuffle (std::mt19937)", bench::measure( [&]
+	{
+		for ( int i = 0; i < iterations; ++i ) ot::shuffle( v.begin(), v.end(), sg );
+		bench::keep( v[0] );
+	}, double( n ) * iterations ), ref );
+}
+
+void bench_sample( std::size_t n, std::size_t k )
+{
+	const int iterations = 200;
+	std::vector<int> population( n );
+	std::vector<int> output( k );
+	std::iota( population.begin(), population.end(), 0 );
+
+	ot::mt19937  og;
+	std::mt19937 sg;
+
+	std::printf( "sample %lu of %lu, per sample\n", (unsigned long) k, (unsigned long) n );
+
+	// Partial Fisher-Yates over a copy of the population, as is usually done without std::sample.
+	const double ref = bench::measure( [&]
+	{
+		for ( int i = 0; i < iterations; ++i )
+		{
+			std::vector<int> copy( population );
+			for ( std::size_t j = 0; j < k; ++j )
+			{
+				std::swap( copy[j], copy[std::uniform_int_distribution<std::size_t>( j, n - 1 )( sg )] );
+			}
+			bench::keep( copy[0] );
+		}
+	}, double( iterations ) );
+	bench::report( "  partial std::shuffle of a copy", ref );
+
+#if __cplusplus >= 201703L
+	bench::report( "  std::sample", bench::measure( [&]
+	{
+		for ( int i = 0; i < iterations; ++i )
+		{
+			std::sample( population.begin(), population.end(), output.begin(), k, sg );
+			bench::keep( output[0] );
+		}
+	}, double( iterations ) ), ref );
+#endif
+
+	bench::report( "  ot::sample_without_replacement", bench::measure( [&]
+	{
+		for ( int i = 0; i < iterations; ++i )
+		{
+			ot::sample_without_replacement( int( n ), k, output.begin(), og );
+			bench::keep( output[0] );
+		}
+	}, double( iterations ) ), ref );
+}
+
+void bench_reservoir( std::size_t n, std::size_t k )
+{
+	std::vector<int> input( n );
+	std::vector<int> output;
+	std::iota( input.begin(), input.end(), 0 );
+
+	ot::mt19937  og;
+	std::mt19937 sg;
+
+	std::printf( "reservoir of %lu over a stream of %lu, per element\n", (unsigned long) k, (unsigned long) n );
+
+	const double ref = bench::measure( [&]
+	{
+		reservoir_r( input, output, k, sg );
+		bench::keep( output[0] );
+	}, double( n ) );
+	bench::report( "  algorithm R (std::mt19937)", ref );
+
+	bench::report( "  ot::reservoir_sampler", bench::measure( [&]
+	{
+		ot::reservoir_sampler<int> sampler( k );
+		for ( std::size_t i = 0; i < n; ++i ) sampler.push( input[i], og );
+		bench::keep( sampler.samples()[0] );
+	}, double( n ) ), ref );
+}
+
+int main()
+{
+	bench_shuffle( 100 );
+	bench_shuffle( 10000 );
+	bench_shuffle( 1000000 );
+	bench_sample( 1000000, 100 );
+	bench_sample( 1000, 500 );
+	bench_reservoir( 10000000, 100 );
+	return 0;
+}
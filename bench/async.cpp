@@ -0,0 +1,62 @@
+/*
+	Copyright (c) 2012 Charly LERSTEAU
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/*
+	Benchmark of ot::steady_state against a stub simulator, a shell command
+	which sleeps 10 ms and prints its first argument, with an increasing
+	number of evaluations in flight.
+
+	Build with:
+		g++ -std=c++11 -O2 -pthread -I../include async.cpp -o async
+*/
+
+#include <cstdio>
+#include <vector>
+#include "async.hpp"
+#include "bench.hpp"
+
+const int evaluations = 64;
+
+int main()
+{
+	typedef std::vector<double> solution;
+
+	ot::command_function<solution> simulator( "sleep 0.01; echo" );
+	bool ok = true;
+
+	std::printf( "%d evaluations of a 10 ms stub process\n", evaluations );
+	for ( std::size_t in_flight = 1; in_flight <= 16; in_flight *= 4 )
+	{
+		ot::async_evaluator<solution> evaluator( simulator, in_flight );
+
+		char name[64];
+		std::snprintf( name, sizeof( name ), "  %d in flight (per evaluation)", int( in_flight ) );
+
+		bench::report( name, bench::measure( [&]
+		{
+			int generated = 0;
+			double sum = 0.0;
+			ot::steady_state( evaluator, evaluations, in_flight,
+				[&] { return solution( 1, double( generated++ ) ); },
+				[&] ( const solution &, double value ) { sum += value; } );
+			ok = ok && ( sum == evaluations * ( evaluations - 1 ) / 2 );
+		}, evaluations, 1 ) );
+	}
+
+	if ( !ok ) std::printf( "FAILED: wrong sum of values\n" );
+	return ok ? 0 : 1;
+}
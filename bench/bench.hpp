@@ -0,0 +1,83 @@
+/*
+	Copyright (c) 2012 Charly LERSTEAU
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef OT_BENCH_BENCH_HPP
+#define OT_BENCH_BENCH_HPP
+
+#include <chrono>
+#include <cstdio>
+
+namespace bench
+{
+
+/*
+	Function: keep<T>
+
+	Prevents the compiler from optimizing away the computation of an
+	arithmetic value.
+*/
+
+template<typename T>
+inline void keep( T x )
+{
+	static volatile T sink;
+	sink = x;
+	(void) sink;
+}
+
+/*
+	Function: measure<F>
+
+	Runs f() several times and returns the best time in nanoseconds per
+	item, f() processing the given number of items at each run.
+*/
+
+template<class F>
+double measure( F f, double items, int runs = 5 )
+{
+	double best = 0.0;
+	for ( int r = 0; r < runs; ++r )
+	{
+		const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		f();
+		const std::chrono::steady_clock::time_point stop = std::chrono::steady_clock::now();
+
+		const double ns = std::chrono::duration<double, std::nano>( stop - start ).count() / items;
+		if ( r == 0 || ns < best ) best = ns;
+	}
+	return best;
+}
+
+/*
+	Function: report
+
+	Prints a line of results.
+*/
+
+inline void report( const char * name, double ns )
+{
+	std::printf( "%-48s %10.2f ns\n", name, ns );
+}
+
+inline void report( const char * name, double ns, double reference )
+{
+	std::printf( "%-48s %10.2f ns  (x%.2f)\n", name, ns, reference / ns );
+}
+
+}
+
+#endif
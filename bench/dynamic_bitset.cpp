@@ -0,0 +1,117 @@
+/*
+	Copyright (c) 2012 Charly LERSTEAU
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/*
+	Benchmark of the population operations of ot::dynamic_bitset against
+	the same operations on std::vector<bool>.
+
+	Build with:
+		g++ -std=c++11 -O2 -march=native -I../include dynamic_bitset.cpp -o dynamic_bitset
+*/
+
+#include <vector>
+#include "dynamic_bitset.hpp"
+#include "bench.hpp"
+
+const std::size_t bits = 10000;
+const int         reps = 2000;
+
+int main()
+{
+	ot::mt19937 g( 1 );
+	ot::uniform_int_distribution<int> coin( 0, 1 );
+	ot::uniform_int_distribution<long> weight( 1, 1000 );
+
+	std::vector<bool> a( bits ), b( bits ), c( bits ), d( bits );
+	std::vector<long> w( bits );
+	for ( std::size_t i = 0; i < bits; ++i ) { a[i] = coin( g ); b[i] = coin( g ); w[i] = weight( g ); }
+	ot::dynamic_bitset x( a ), y( b ), u, v;
+	const ot::bit_weights<long> bw( w.begin(), w.end() );
+	const double items = double( bits ) * reps;
+
+	std::printf( "Hamming distance, per bit\n" );
+	const double href = bench::measure( [&]
+	{
+		std::size_t s = 0;
+		for ( int r = 0; r < reps; ++r ) for ( std::size_t i = 0; i < bits; ++i ) s += a[i] != b[i];
+		bench::keep( s );
+	}, items );
+	bench::report( "  std::vector<bool>", href );
+	bench::report( "  ot::hamming_distance", bench::measure( [&]
+	{
+		std::size_t s = 0;
+		for ( int r = 0; r < reps; ++r ) s += ot::hamming_distance( x, y );
+		bench::keep( s );
+	}, items ), href );
+
+	std::printf( "weighted sum of a knapsack solution, per bit\n" );
+	const double wref = bench::measure( [&]
+	{
+		long s = 0;
+		for ( int r = 0; r < reps; ++r ) for ( std::size_t i = 0; i < bits; ++i ) if ( a[i] ) s += w[i];
+		bench::keep( s );
+	}, items );
+	bench::report( "  std::vector<bool>", wref );
+	bench::report( "  ot::dot (set bits)", bench::measure( [&]
+	{
+		long s = 0;
+		for ( int r = 0; r < reps; ++r ) s += ot::dot( x, w.begin() );
+		bench::keep( s );
+	}, items ), wref );
+	bench::report( "  ot::bit_weights (10 planes)", bench::measure( [&]
+	{
+		long s = 0;
+		for ( int r = 0; r < reps; ++r ) s += bw( x );
+		bench::keep( s );
+	}, items ), wref );
+
+	std::printf( "uniform crossover, per bit\n" );
+	const double cref = bench::measure( [&]
+	{
+		for ( int r = 0; r < reps; ++r )
+		{
+			for ( std::size_t i = 0; i < bits; ++i )
+			{
+				const bool s = coin( g );
+				c[i] = s ? a[i] : b[i];
+				d[i] = s ? b[i] : a[i];
+			}
+		}
+		bench::keep( bool( c[0] ) );
+	}, items );
+	bench::report( "  std::vector<bool>", cref );
+	bench::report( "  ot::uniform_crossover", bench::measure( [&]
+	{
+		for ( int r = 0; r < reps; ++r ) ot::uniform_crossover( x, y, u, v, g );
+		bench::keep( u.count() );
+	}, items ), cref );
+
+	std::printf( "mutation at rate 1/8, per bit\n" );
+	ot::uniform_real_distribution<double> uniform;
+	const double mref = bench::measure( [&]
+	{
+		for ( int r = 0; r < reps; ++r ) for ( std::size_t i = 0; i < bits; ++i ) if ( uniform( g ) < 0.125 ) c[i] = !c[i];
+		bench::keep( bool( c[0] ) );
+	}, items );
+	bench::report( "  std::vector<bool>", mref );
+	bench::report( "  ot::mutate", bench::measure( [&]
+	{
+		for ( int r = 0; r < reps; ++r ) ot::mutate( u, 0.125, g );
+		bench::keep( u.count() );
+	}, items ), mref );
+	return 0;
+}
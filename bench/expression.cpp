@@ -0,0 +1,97 @@
+/*
+	Copyright (c) 2012 Charly LERSTEAU
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/*
+	Benchmark of the expression templates on the mutation of differential
+	evolution y = a + w * ( b - c ), against a hand-written loop, a loop
+	with temporaries and std::valarray.
+
+	Build with:
+		g++ -std=c++11 -O3 -march=native -I../include expression.cpp -o expression
+*/
+
+#include <valarray>
+#include <vector>
+#include "expression.hpp"
+#include "bench.hpp"
+
+const std::size_t n = 1000;
+const int repeats = 20000;
+
+// Operator by operator, with a temporary vector for each one.
+std::vector<double> temporaries( const std::vector<double> & a, const std::vector<double> & b, const std::vector<double> & c, double w )
+{
+	std::vector<double> d( b.size() ), e( b.size() ), y( b.size() );
+	for ( std::size_t i = 0; i < b.size(); ++i ) d[i] = b[i] - c[i];
+	for ( std::size_t i = 0; i < b.size(); ++i ) e[i] = w * d[i];
+	for ( std::size_t i = 0; i < b.size(); ++i ) y[i] = a[i] + e[i];
+	return y;
+}
+
+int main()
+{
+	std::vector<double> a( n ), b( n ), c( n ), y( n );
+	for ( std::size_t i = 0; i < n; ++i )
+	{
+		a[i] = double( i );
+		b[i] = double( i % 7 );
+		c[i] = double( i % 3 );
+	}
+	std::valarray<double> va( a.data(), n ), vb( b.data(), n ), vc( c.data(), n ), vy( n );
+	const double w = 0.5;
+
+	std::printf( "y = a + w * ( b - c ), %d elements\n", int( n ) );
+
+	const double loop = bench::measure( [&]
+	{
+		for ( int r = 0; r < repeats; ++r )
+		{
+			for ( std::size_t i = 0; i < n; ++i ) y[i] = a[i] + w * ( b[i] - c[i] );
+			bench::keep( y[r % n] );
+		}
+	}, double( n ) * repeats );
+	bench::report( "  hand-written loop (per element)", loop );
+
+	bench::report( "  ot::view expression", bench::measure( [&]
+	{
+		for ( int r = 0; r < repeats; ++r )
+		{
+			ot::view( y ) = ot::view( a ) + w * ( ot::view( b ) - ot::view( c ) );
+			bench::keep( y[r % n] );
+		}
+	}, double( n ) * repeats ), loop );
+
+	bench::report( "  std::valarray", bench::measure( [&]
+	{
+		for ( int r = 0; r < repeats; ++r )
+		{
+			vy = va + w * ( vb - vc );
+			bench::keep( vy[r % n] );
+		}
+	}, double( n ) * repeats ), loop );
+
+	bench::report( "  temporaries", bench::measure( [&]
+	{
+		for ( int r = 0; r < repeats; ++r )
+		{
+			y = temporaries( a, b, c, w );
+			bench::keep( y[r % n] );
+		}
+	}, double( n ) * repeats ), loop );
+
+	return 0;
+}
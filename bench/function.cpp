@@ -0,0 +1,95 @@
+/*
+	Copyright (c) 2012 Charly LERSTEAU
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/*
+	Benchmark of the call overhead of ot::function_ref and ot::function,
+	against a direct call and std::function.
+
+	Build with:
+		g++ -std=c++11 -O2 -I../include function.cpp -o function
+*/
+
+#include <functional>
+#include <vector>
+#include "function.hpp"
+#include "bench.hpp"
+
+const int calls = 100000000;
+
+struct objective
+{
+	double a;
+	double operator () ( double x ) const { return a * x + 1.0; }
+	double evaluate( double x ) const { return a * x + 1.0; }
+};
+
+// Loops over calls of f, which the compiler cannot inline unless F is the functor itself.
+template<class F>
+double __attribute__(( noinline )) run( const F & f )
+{
+	double sum = 0.0;
+	for ( int i = 0; i < calls; ++i )
+	{
+		sum += f( double( i ) );
+	}
+	return sum;
+}
+
+int main()
+{
+	const objective o = { 0.5 };
+
+	std::printf( "call of a small functor, per call\n" );
+
+	const double ref = bench::measure( [&] { bench::keep( run( o ) ); }, calls );
+	bench::report( "  direct call", ref );
+
+	const ot::function_ref<double(double)> r( o );
+	bench::report( "  ot::function_ref", bench::measure( [&] { bench::keep( run( r ) ); }, calls ), ref );
+
+	const ot::function_ref<double(double)> m = ot::function_ref<double(double)>::from_method<objective, &objective::evaluate>( &o );
+	bench::report( "  ot::function_ref::from_method", bench::measure( [&] { bench::keep( run( m ) ); }, calls ), ref );
+
+	const ot::function<double(double)> f( o );
+	bench::report( "  ot::function", bench::measure( [&] { bench::keep( run( f ) ); }, calls ), ref );
+
+	const std::function<double(double)> s( o );
+	bench::report( "  std::function", bench::measure( [&] { bench::keep( run( s ) ); }, calls ), ref );
+
+	std::printf( "construction and call of a wrapper around a capturing lambda\n" );
+	{
+		const int n = 10000000;
+		std::vector<double> capture( 3, 1.0 );
+		auto lambda = [capture]( double x ) { return capture[0] * x; };
+
+		const double sref = bench::measure( [&]
+		{
+			double sum = 0.0;
+			for ( int i = 0; i < n; ++i ) { std::function<double(double)> w( std::ref( lambda ) ); sum += w( 1.0 ); }
+			bench::keep( sum );
+		}, n );
+		bench::report( "  std::function (std::ref)", sref );
+
+		bench::report( "  ot::function_ref", bench::measure( [&]
+		{
+			double sum = 0.0;
+			for ( int i = 0; i < n; ++i ) { ot::function_ref<double(double)> w( lambda ); sum += w( 1.0 ); }
+			bench::keep( sum );
+		}, n ), sref );
+	}
+	return 0;
+}
@@ -0,0 +1,243 @@
+/*
+	Copyright (c) 2012 Charly LERSTEAU
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/*
+	Benchmark and smoke test of the engines and distributions of random.hpp.
+
+	Measures the time per draw of the ot engines against the std engines,
+	the cost of seed() and discard(), and the cost of the distributions.
+	Then runs quick statistical tests (chi-square, birthday spacings) and
+	checks outputs against reference values, so that optimizations cannot
+	silently change the generated sequences. Returns a nonzero status if
+	a check fails.
+
+	Build with:
+		g++ -std=c++11 -O2 -I../include random.cpp -o random
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+#include "random.hpp"
+#include "bench.hpp"
+
+const int draws = 10000000;
+
+template<class E>
+void bench_engine( const char * name )
+{
+	E e;
+	std::vector<typename E::result_type> v( 4096 );
+	char label[64];
+
+	std::snprintf( label, sizeof( label ), "  %s: draw", name );
+	bench::report( label, bench::measure( [&]
+	{
+		typename E::result_type sum = 0;
+		for ( int i = 0; i < draws; ++i ) sum += e();
+		bench::keep( sum );
+	}, draws ) );
+
+	std::snprintf( label, sizeof( label ), "  %s: fill a buffer", name );
+	bench::report( label, bench::measure( [&]
+	{
+		for ( int i = 0; i < draws; i += int( v.size() ) ) std::generate( v.begin(), v.end(), std::ref( e ) );
+		bench::keep( v[0] );
+	}, draws ) );
+
+	std::snprintf( label, sizeof( label ), "  %s: seed()", name );
+	bench::report( label, bench::measure( [&]
+	{
+		// Seeds drawn at run time, each seeded state being used, so that the
+		// loop is neither folded nor reduced to its last seed.
+		typename E::result_type sum = 0;
+		for ( int i = 0; i < 10000; ++i ) { e.seed( v[i % v.size()] ); sum += e(); }
+		bench::keep( sum );
+	}, 10000 ) );
+
+	std::snprintf( label, sizeof( label ), "  %s: discard(), per step", name );
+	bench::report( label, bench::measure( [&]
+	{
+		e.discard( draws );
+		bench::keep( e() );
+	}, draws ) );
+}
+
+template<class D, class E>
+void bench_distribution( const char * name, D d )
+{
+	E e;
+	char label[64];
+
+	std::snprintf( label, sizeof( label ), "  %s", name );
+	bench::report( label, bench::measure( [&]
+	{
+		typename D::result_type sum = 0;
+		for ( int i = 0; i < draws; ++i ) sum += d( e );
+		bench::keep( sum );
+	}, draws ) );
+}
+
+template<class D, class E>
+void bench_generate( const char * name, D d )
+{
+	E e;
+	std::vector<typename D::result_type> v( 4096 );
+	char label[64];
+
+	std::snprintf( label, sizeof( label ), "  %s, generate()", name );
+	bench::report( label, bench::measure( [&]
+	{
+		for ( int i = 0; i < draws; i += int( v.size() ) ) d.generate( v.begin(), v.end(), e );
+		bench::keep( v[0] );
+	}, draws ) );
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+int failures = 0;
+
+void check( const char * name, bool ok )
+{
+	std::printf( "  %-46s %s\n", name, ok ? "ok" : "FAILED" );
+	if ( !ok ) ++failures;
+}
+
+// Chi-square test of 2^20 bytes taken from the high bits of the engine,
+// with 255 degrees of freedom: accepts within 5 standard deviations.
+template<class E>
+bool chi_square_test( E & e )
+{
+	const int n = 1 << 20;
+	std::vector<double> count( 256, 0.0 );
+	for ( int i = 0; i < n; ++i )
+	{
+		++count[ot::detail::generate_word32( e ) >> 24];
+	}
+
+	double chi = 0.0;
+	const double expected = n / 256.0;
+	for ( int i = 0; i < 256; ++i )
+	{
+		chi += ( count[i] - expected ) * ( count[i] - expected ) / expected;
+	}
+	return std::fabs( chi - 255.0 ) < 5.0 * std::sqrt( 2.0 * 255.0 );
+}
+
+// Birthday spacings test (Marsaglia): m = 512 birthdays in a year of
+// 2^24 days, the number of repeated spacings is Poisson with mean
+// m^3 / (4 * 2^24) = 2. Sums 500 runs and accepts within 5 standard
+// deviations of the Poisson(1000) mean.
+template<class E>
+bool birthday_spacings_test( E & e )
+{
+	const int m = 512;
+	const int runs = 500;
+	std::vector<uint32_t> days( m ), spacings( m );
+	long repeats = 0;
+
+	for ( int r = 0; r < runs; ++r )
+	{
+		for ( int i = 0; i < m; ++i ) days[i] = ot::detail::generate_word32( e ) >> 8;
+		std::sort( days.begin(), days.end() );
+
+		spacings[0] = days[0];
+		for ( int i = 1; i < m; ++i ) spacings[i] = days[i] - days[i-1];
+		std::sort( spacings.begin(), spacings.end() );
+
+		for ( int i = 1; i < m; ++i ) repeats += ( spacings[i] == spacings[i-1] );
+	}
+	return std::fabs( repeats - 1000.0 ) < 5.0 * std::sqrt( 1000.0 );
+}
+
+// The 10000th output of default-constructed engines, as specified by C++11.
+template<class E>
+bool reference_test( typename E::result_type expected )
+{
+	E e;
+	e.discard( 9999 );
+	return e() == expected;
+}
+
+// Hash of the first outputs of a distribution, to detect changes of the
+// sequence. Values are rounded to 1e-9, so that the last bits of the math
+// library functions used to build the ziggurat tables do not matter.
+template<class D>
+uint64_t sequence_hash( D d )
+{
+	ot::mt19937 e;
+	uint64_t h = UINT64_C(0xcbf29ce484222325);
+	for ( int i = 0; i < 10000; ++i )
+	{
+		h = ot::detail::hash_combine( h, uint64_t( std::llround( double( d( e ) ) * 1e9 ) ) );
+	}
+	return h;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+int main()
+{
+	std::printf( "engines, per draw\n" );
+	bench_engine<ot::minstd_rand0>( "ot::minstd_rand0" );
+	bench_engine<std::minstd_rand0>( "std::minstd_rand0" );
+	bench_engine<ot::minstd_rand>( "ot::minstd_rand" );
+	bench_engine<std::minstd_rand>( "std::minstd_rand" );
+	bench_engine<ot::mt19937>( "ot::mt19937" );
+	bench_engine<std::mt19937>( "std::mt19937" );
+
+	std::printf( "distributions with mt19937, per draw\n" );
+	bench_distribution<ot::uniform_int_distribution<int>, ot::mt19937>( "ot::uniform_int_distribution", ot::uniform_int_distribution<int>( 0, 999 ) );
+	bench_generate<ot::uniform_int_distribution<int>, ot::mt19937>( "ot::uniform_int_distribution", ot::uniform_int_distribution<int>( 0, 999 ) );
+	bench_distribution<std::uniform_int_distribution<int>, std::mt19937>( "std::uniform_int_distribution", std::uniform_int_distribution<int>( 0, 999 ) );
+	bench_distribution<ot::uniform_real_distribution<double>, ot::mt19937>( "ot::uniform_real_distribution", ot::uniform_real_distribution<double>() );
+	bench_generate<ot::uniform_real_distribution<double>, ot::mt19937>( "ot::uniform_real_distribution", ot::uniform_real_distribution<double>() );
+	bench_distribution<std::uniform_real_distribution<double>, std::mt19937>( "std::uniform_real_distribution", std::uniform_real_distribution<double>() );
+	bench_distribution<ot::normal_distribution<double>, ot::mt19937>( "ot::normal_distribution", ot::normal_distribution<double>() );
+	bench_generate<ot::normal_distribution<double>, ot::mt19937>( "ot::normal_distribution", ot::normal_distribution<double>() );
+	bench_distribution<std::normal_distribution<double>, std::mt19937>( "std::normal_distribution", std::normal_distribution<double>() );
+	bench_distribution<ot::exponential_distribution<double>, ot::mt19937>( "ot::exponential_distribution", ot::exponential_distribution<double>() );
+	bench_distribution<std::exponential_distribution<double>, std::mt19937>( "std::exponential_distribution", std::exponential_distribution<double>() );
+
+	const double weights[] = { 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16 };
+	bench_distribution<ot::discrete_distribution<int>, ot::mt19937>( "ot::discrete_distribution (16)", ot::discrete_distribution<int>( weights, weights + 16 ) );
+	bench_distribution<std::discrete_distribution<int>, std::mt19937>( "std::discrete_distribution (16)", std::discrete_distribution<int>( weights, weights + 16 ) );
+
+	std::printf( "statistical tests\n" );
+	{
+		ot::minstd_rand0 e0;
+		ot::minstd_rand  e1;
+		ot::mt19937      e2;
+		check( "minstd_rand0 chi-square", chi_square_test( e0 ) );
+		check( "minstd_rand chi-square", chi_square_test( e1 ) );
+		check( "mt19937 chi-square", chi_square_test( e2 ) );
+		check( "mt19937 birthday spacings", birthday_spacings_test( e2 ) );
+	}
+
+	std::printf( "reference sequences\n" );
+	check( "minstd_rand0 10000th output", reference_test<ot::minstd_rand0>( 1043618065u ) );
+	check( "minstd_rand 10000th output", reference_test<ot::minstd_rand>( 399268537u ) );
+	check( "mt19937 10000th output", reference_test<ot::mt19937>( 4123659995u ) );
+	check( "uniform_int_distribution sequence", sequence_hash( ot::uniform_int_distribution<int>( -100, 100 ) ) == UINT64_C(0x4c22c57705645f52) );
+	check( "uniform_real_distribution sequence", sequence_hash( ot::uniform_real_distribution<double>( -1, 1 ) ) == UINT64_C(0xa36f36aeec1485c1) );
+	check( "normal_distribution sequence", sequence_hash( ot::normal_distribution<double>() ) == UINT64_C(0x7984dc0855bd1a1a) );
+	check( "exponential_distribution sequence", sequence_hash( ot::exponential_distribution<double>() ) == UINT64_C(0xfb2ea66216e3642b) );
+	check( "discrete_distribution sequence", sequence_hash( ot::discrete_distribution<int>( weights, weights + 16 ) ) == UINT64_C(0x53e27bc788dd8821) );
+
+	return failures == 0 ? 0 : 1;
+}
@@ -19,7 +19,15 @@
 #define OT_ALGORITHM_HPP
 
 #include <algorithm>
+#include <cmath>
+#include <iterator>
+#include <utility>
 #include <vector>
+#include "random.hpp"
+
+#if __cplusplus > 201100L || __GXX_EXPERIMENTAL_CXX0X__
+#include <type_traits>
+#endif
 
 namespace ot
 {
@@ -157,10 +165,306 @@ inline bool strictly_dominates( I1 first1, I1 last1, I2 first2, I2 last2, P p )
 	return true;
 }
 
+/*
+	Function: shuffle<I, G>
+
+	(C++11) Reorders the elements in the range [first, last) such that each
+	permutation has the same probability, using the Fisher-Yates algorithm.
+
+	With engines producing full 32-bit words, the two indices of consecutive
+	steps are drawn from a single word as long as their product fits in
+	32 bits, i.e. for the last 65536 positions.
+*/
+
+template<typename I, class G>
+void shuffle( I first, I last, G & g )
+{
+	typedef typename std::iterator_traits<I>::difference_type difference_type;
+
+	const difference_type n = last - first;
+	if ( n < 2 ) return;
+
+	uint64_t i = uint64_t( n - 1 );
+
+	// Large positions: one bounded integer per step.
+	const bool pairs = detail::is_word32_engine<G>();
+	const uint64_t limit = pairs ? 65535u : 0u;
+	for ( ; i > limit; --i )
+	{
+		const uint64_t j = uniform_int_distribution<uint64_t>( 0, i )( g );
+		std::iter_swap( first + difference_type( i ), first + difference_type( j ) );
+	}
+
+	// Small positions: two bounded integers per random word.
+	uint32_t j1, j2;
+	for ( ; i > 1; i -= 2 )
+	{
+		detail::generate_bounded_pair32( g, uint32_t( i + 1 ), uint32_t( i ), j1, j2 );
+		std::iter_swap( first + difference_type( i ), first + difference_type( j1 ) );
+		std::iter_swap( first + difference_type( i - 1 ), first + difference_type( j2 ) );
+	}
+	if ( i == 1 )
+	{
+		std::iter_swap( first + 1, first + difference_type( uniform_int_distribution<uint32_t>( 0, 1 )( g ) ) );
+	}
+}
+
+/*
+	Function: sample_without_replacement<INT, O, G>
+
+	Writes k distinct integers drawn uniformly from [0, n) to the output
+	iterator, using Floyd's algorithm: exactly k bounded integers are drawn,
+	and membership is tested in an open-addressing hash set of about 2k
+	words, so the cost does not depend on n. The integers are written in
+	insertion order, which is not a uniformly random order; use <shuffle>
+	on the output if needed.
+
+	See:
+		J. Bentley, R. Floyd, Programming Pearls: A Sample of Brilliance, 1987.
+*/
+
+template<typename INT, typename O, class G>
+O sample_without_replacement( INT n, std::size_t k, O out, G & g )
+{
+	if ( uint64_t( k ) > uint64_t( n ) ) k = std::size_t( n );
+	if ( k == 0 ) return out;
+
+	// Slots hold value + 1, so that 0 marks an empty slot.
+	std::size_t shift = 64;
+	std::size_t size  = 1;
+	while ( size < 2 * k )
+	{
+		size <<= 1;
+		--shift;
+	}
+	std::vector<uint64_t> table( size, 0 );
+	const uint64_t mask = size - 1;
+
+	for ( uint64_t j = uint64_t( n ) - k; j < uint64_t( n ); ++j )
+	{
+		uint64_t t = uniform_int_distribution<uint64_t>( 0, j )( g );
+
+		// Fibonacci hashing and linear probing.
+		uint64_t h = ( t * UINT64_C(0x9e3779b97f4a7c15) ) >> shift;
+		for ( ; table[h] != 0; h = ( h + 1 ) & mask )
+		{
+			if ( table[h] == t + 1 )
+			{
+				// t was already chosen: choose j instead, which cannot be in the set.
+				t = j;
+				h = ( t * UINT64_C(0x9e3779b97f4a7c15) ) >> shift;
+				while ( table[h] != 0 ) h = ( h + 1 ) & mask;
+				break;
+			}
+		}
+		table[h] = t + 1;
+		*out = INT( t );
+		++out;
+	}
+	return out;
 }
 
+/*
+	Class: reservoir_sampler<T>
+
+	Maintains a uniform random sample of k elements from a stream of
+	unknown length. Uses Li's algorithm L, which computes the number of
+	elements to skip before the next replacement, so that the number of
+	random draws is O(k (1 + log(N / k))) rather than O(N).
+
+	See:
+		K.-H. Li, Reservoir-Sampling Algorithms of Time Complexity O(n(1 + log(N/n))), 1994.
+*/
+
+template<typename T>
+class reservoir_sampler
+{
+public:
+	explicit reservoir_sampler( std::size_t k ) : _k( k ), _count( 0 ), _next( 0 ), _w( 1.0 )
+	{
+		_samples.reserve( k );
+	}
+
+	template<class G>
+	void push( const T & x, G & g )
+	{
+		if ( _count < _k )
+		{
+			_samples.push_back( x );
+			if ( ++_count == _k ) skip( g );
+			return;
+		}
+		if ( _count++ == _next && _k > 0 )
+		{
+			_samples[uniform_int_distribution<std::size_t>( 0, _k - 1 )( g )] = x;
+			skip( g );
+		}
+	}
+
+	const std::vector<T> & samples() const { return _samples; }
+	uint64_t count() const { return _count; }
+
+	void clear()
+	{
+		_samples.clear();
+		_count = 0;
+		_next  = 0;
+		_w     = 1.0;
+	}
+
+private:
+	// Updates the weight and the index of the next element to keep.
+	template<class G>
+	void skip( G & g )
+	{
+		_w *= std::exp( std::log( unit( g ) ) / double( _k ) );
+		const double s = std::floor( std::log( unit( g ) ) / std::log( 1.0 - _w ) );
+		const uint64_t last = _count - 1;
+		_next = ( s < 1.8e19 - double( last ) ) ? last + uint64_t( s ) + 1 : ~uint64_t();
+	}
+
+	// Uniform value in (0, 1].
+	template<class G>
+	static double unit( G & g )
+	{
+		return 1.0 - detail::unit_generator<double>::generate( g );
+	}
+
+	std::size_t    _k;
+	uint64_t       _count;
+	uint64_t       _next;
+	double         _w;
+	std::vector<T> _samples;
+};
+
+/*
+	Function: sort_by_key<I, K>
+
+	Sorts the range [first, last) by increasing key( x ), computing each key
+	once instead of twice per comparison: the keys are stored with the
+	positions in a contiguous array, which is sorted, and the range is then
+	permuted in place by swaps. Equal keys keep their order.
+
+	Useful when keys are expensive, such as scalarized objectives.
+*/
+
+template<typename I, class K>
+void sort_by_key( I first, I last, K key );
+
+/*
+	Function: partial_sort_by_key<I, K>
+
+	Like std::partial_sort, by increasing key( x ), computing each key once.
+*/
+
+template<typename I, class K>
+void partial_sort_by_key( I first, I middle, I last, K key );
+
+/*
+	Function: nth_element_by_key<I, K>
+
+	Like std::nth_element, by increasing key( x ), computing each key once.
+*/
+
+template<typename I, class K>
+void nth_element_by_key( I first, I nth, I last, K key );
+
 ////////////////////////////////////////////////////////////////////////////////
 
+namespace detail
+{
+
+template<class K, typename T>
+struct key_result
+{
+#if __cplusplus > 201100L || __GXX_EXPERIMENTAL_CXX0X__
+	typedef typename std::decay<decltype( std::declval<K &>()( std::declval<T>() ) )>::type type;
+#else
+	typedef typename K::result_type type;
+#endif
+};
+
+// Orders by key, then by position, so that sorts are stable.
+template<typename KEY>
+struct key_position_less
+{
+	bool operator () ( const std::pair<KEY, std::size_t> & a, const std::pair<KEY, std::size_t> & b ) const
+	{
+		return ( a.first < b.first ) || ( !( b.first < a.first ) && a.second < b.second );
+	}
+};
+
+template<typename I, class K>
+void compute_keys( I first, I last, K & key, std::vector< std::pair<typename key_result<K, typename std::iterator_traits<I>::reference>::type, std::size_t> > & keys )
+{
+	keys.reserve( std::size_t( last - first ) );
+	for ( std::size_t i = 0; first != last; ++first, ++i )
+	{
+		keys.push_back( std::make_pair( key( *first ), i ) );
+	}
+}
+
+// Moves the element at position keys[i].second to position i, following the cycles of the permutation.
+template<typename I, typename KEY>
+void apply_key_order( I first, const std::vector< std::pair<KEY, std::size_t> > & keys )
+{
+	std::vector<bool> done( keys.size(), false );
+	for ( std::size_t i = 0; i < keys.size(); ++i )
+	{
+		if ( done[i] ) continue;
+		std::size_t j = i;
+		for ( ; keys[j].second != i; j = keys[j].second )
+		{
+			std::iter_swap( first + j, first + keys[j].second );
+			done[j] = true;
+		}
+		done[j] = true;
+	}
+}
+
+}
+
+template<typename I, class K>
+void sort_by_key( I first, I last, K key )
+{
+	typedef typename detail::key_result<K, typename std::iterator_traits<I>::reference>::type key_type;
+
+	std::vector< std::pair<key_type, std::size_t> > keys;
+	detail::compute_keys( first, last, key, keys );
+	std::sort( keys.begin(), keys.end(), detail::key_position_less<key_type>() );
+	detail::apply_key_order( first, keys );
+}
+
+template<typename I, class K>
+void partial_sort_by_key( I first, I middle, I last, K key )
+{
+	typedef typename detail::key_result<K, typename std::iterator_traits<I>::reference>::type key_type;
+
+	std::vector< std::pair<key_type, std::size_t> > keys;
+	detail::compute_keys( first, last, key, keys );
+	std::partial_sort( keys.begin(), keys.begin() + ( middle - first ), keys.end(), detail::key_position_less<key_type>() );
+	detail::apply_key_order( first, keys );
+}
+
+template<typename I, class K>
+void nth_element_by_key( I first, I nth, I last, K key )
+{
+	typedef typename detail::key_result<K, typename std::iterator_traits<I>::reference>::type key_type;
+
+	if ( nth == last ) return;
+	std::vector< std::pair<key_type, std::size_t> > keys;
+	detail::compute_keys( first, last, key, keys );
+	std::nth_element( keys.begin(), keys.begin() + ( nth - first ), keys.end(), detail::key_position_less<key_type>() );
+	detail::apply_key_order( first, keys );
+}
+
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+// Since C++11, the standard library already provides swap for std::vector<bool>.
+#if !( __cplusplus > 201100L || __GXX_EXPERIMENTAL_CXX0X__ )
+
 namespace std
 {
 
@@ -176,3 +480,5 @@ inline void swap( vector<bool>::reference a, vector<bool>::reference b )
 
 #endif
 
+#endif
+
@@ -0,0 +1,347 @@
+/*
+	Copyright (c) 2012 Charly LERSTEAU
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef OT_ASYNC_HPP
+#define OT_ASYNC_HPP
+
+#if !( __cplusplus > 201100L || __GXX_EXPERIMENTAL_CXX0X__ )
+#error "async.hpp requires C++11."
+#endif
+
+#include <cctype>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <exception>
+#include <future>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include "function.hpp"
+#include "thread_pool.hpp"
+
+#if !defined( _WIN32 )
+#include <sys/wait.h>
+#endif
+
+namespace ot
+{
+
+/*
+	Class: async_evaluator<X, R>
+
+	Evaluates solutions asynchronously with up to a given number of
+	evaluations running at once, for objectives which wait on an external
+	simulator rather than compute.
+
+	<submit> returns a std::future of the value. <post> returns a ticket,
+	and the completed evaluations are then retrieved in order of completion
+	with <next>, which is what <steady_state> uses.
+
+	The function is called concurrently and must be thread-safe. The
+	destructor waits for the evaluations in flight.
+*/
+
+template<class X, typename R = double>
+class async_evaluator
+{
+public:
+	typedef X solution_type;
+	typedef R result_type;
+	typedef function<R(const X &)> function_type;
+
+	struct completion
+	{
+		std::size_t        ticket;
+		X                  solution;
+		R                  value;
+		std::exception_ptr error;
+
+		// Value, or the exception thrown by the evaluation.
+		const R & get() const
+		{
+			if ( error ) std::rethrow_exception( error );
+			return value;
+		}
+	};
+
+	async_evaluator( function_type f, std::size_t concurrency ) : _function( std::move( f ) ), _tickets( 0 ), _in_flight( 0 ), _pool( concurrency + 1 ) {}
+
+	std::future<R> submit( X x );
+	std::size_t post( X x );
+
+	bool next( completion & c );
+	bool try_next( completion & c );
+
+	std::size_t in_flight() const;
+	std::size_t concurrency() const { return _pool.size() - 1; }
+
+private:
+	async_evaluator( const async_evaluator & );
+	async_evaluator & operator = ( const async_evaluator & );
+
+	function_type           _function;
+	mutable std::mutex      _mutex;
+	std::condition_variable _done;
+	std::deque<completion>  _completions;
+	std::size_t             _tickets;
+	std::size_t             _in_flight;
+	thread_pool             _pool; // Last, so that it stops first.
+};
+
+/*
+	Function: steady_state
+
+	Keeps up to in_flight evaluations running until the given number of
+	evaluations is reached: each completed evaluation is passed to
+	accept( x, value ) and replaced by a new solution from generate().
+	Both are called by the calling thread only. An exception thrown by an
+	evaluation is rethrown.
+*/
+
+template<class X, typename R, class G, class A>
+void steady_state( async_evaluator<X, R> & e, std::size_t evaluations, std::size_t in_flight, G generate, A accept );
+
+/*
+	Class: command_function<X>
+
+	Objective computed by an external program: the command is run by the
+	shell with the elements of the solution as arguments, and the first
+	number in its output, wherever it appears, is the value. The elements
+	must be arithmetic, so that each one is passed as a single number which
+	the shell cannot interpret. Throws std::runtime_error if the command
+	cannot be run, does not exit with status 0, or prints no number.
+*/
+
+template<class X>
+class command_function
+{
+public:
+	explicit command_function( const std::string & command ) : _command( command ) {}
+
+	double operator () ( const X & x ) const;
+
+private:
+	static_assert( std::is_arithmetic<typename X::value_type>::value, "ot::command_function: the elements of the solution must be arithmetic" );
+
+	std::string _command;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+template<class X, typename R>
+std::future<R> async_evaluator<X, R>::submit( X x )
+{
+	struct task
+	{
+		const function_type * f;
+		X                     x;
+		std::promise<R>       promise;
+
+		void operator () ()
+		{
+			try
+			{
+				promise.set_value( ( *f )( x ) );
+			}
+			catch ( ... )
+			{
+				promise.set_exception( std::current_exception() );
+			}
+		}
+	};
+
+	task t = { &_function, std::move( x ), std::promise<R>() };
+	std::future<R> result = t.promise.get_future();
+	_pool.submit( std::move( t ) );
+	return result;
+}
+
+template<class X, typename R>
+std::size_t async_evaluator<X, R>::post( X x )
+{
+	struct task
+	{
+		async_evaluator * e;
+		completion        c;
+
+		void operator () ()
+		{
+			try
+			{
+				c.value = e->_function( c.solution );
+			}
+			catch ( ... )
+			{
+				c.error = std::current_exception();
+			}
+
+			{
+				std::lock_guard<std::mutex> lock( e->_mutex );
+				e->_completions.push_back( std::move( c ) );
+			}
+			e->_done.notify_one();
+		}
+	};
+
+	task t = { this, completion() };
+	t.c.solution = std::move( x );
+	{
+		std::lock_guard<std::mutex> lock( _mutex );
+		t.c.ticket = _tickets++;
+		++_in_flight;
+	}
+	const std::size_t ticket = t.c.ticket;
+	_pool.submit( std::move( t ) );
+	return ticket;
+}
+
+/*
+	Method: next
+
+	Waits for the next completed evaluation of <post>. Returns false if
+	there is none in flight.
+*/
+
+template<class X, typename R>
+bool async_evaluator<X, R>::next( completion & c )
+{
+	std::unique_lock<std::mutex> lock( _mutex );
+	if ( _in_flight == 0 ) return false;
+
+	_done.wait( lock, [this] { return !_completions.empty(); } );
+	c = std::move( _completions.front() );
+	_completions.pop_front();
+	--_in_flight;
+	return true;
+}
+
+template<class X, typename R>
+bool async_evaluator<X, R>::try_next( completion & c )
+{
+	std::lock_guard<std::mutex> lock( _mutex );
+	if ( _completions.empty() ) return false;
+
+	c = std::move( _completions.front() );
+	_completions.pop_front();
+	--_in_flight;
+	return true;
+}
+
+/*
+	Method: in_flight
+
+	Number of evaluations posted and not yet retrieved.
+*/
+
+template<class X, typename R>
+std::size_t async_evaluator<X, R>::in_flight() const
+{
+	std::lock_guard<std::mutex> lock( _mutex );
+	return _in_flight;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+template<class X, typename R, class G, class A>
+void steady_state( async_evaluator<X, R> & e, std::size_t evaluations, std::size_t in_flight, G generate, A accept )
+{
+	typename async_evaluator<X, R>::completion c;
+	std::size_t posted = 0;
+
+	for ( ;; )
+	{
+		while ( posted < evaluations && e.in_flight() < in_flight )
+		{
+			e.post( generate() );
+			++posted;
+		}
+		if ( !e.next( c ) ) return;
+		accept( c.solution, c.get() );
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace detail
+{
+
+// Parses the first number of a text: at a digit, or at a sign or a point
+// followed by a digit.
+inline bool first_number( const std::string & text, double & value )
+{
+	const char * s = text.c_str();
+	for ( std::size_t i = 0; i < text.size(); ++i )
+	{
+		std::size_t j = i;
+		if ( s[j] == '+' || s[j] == '-' ) ++j;
+		if ( s[j] == '.' ) ++j;
+		if ( !std::isdigit( static_cast<unsigned char>( s[j] ) ) ) continue;
+
+		char * end;
+		value = std::strtod( s + i, &end );
+		if ( end != s + i ) return true;
+	}
+	return false;
+}
+
+}
+
+template<class X>
+double command_function<X>::operator () ( const X & x ) const
+{
+	std::ostringstream os;
+	os.precision( 17 );
+	os << _command;
+	// Promoted, so that characters are written as numbers.
+	for ( typename X::const_iterator it = x.begin(); it != x.end(); ++it ) os << ' ' << +*it;
+
+#if defined( _WIN32 )
+	std::FILE * pipe = _popen( os.str().c_str(), "r" );
+#else
+	std::FILE * pipe = popen( os.str().c_str(), "r" );
+#endif
+	if ( !pipe ) throw std::runtime_error( "ot::command_function: cannot run " + _command );
+
+	// The whole output is read, so that the command does not get SIGPIPE.
+	std::string output;
+	char buffer[256];
+	std::size_t n;
+	while ( ( n = std::fread( buffer, 1, sizeof( buffer ), pipe ) ) > 0 ) output.append( buffer, n );
+
+#if defined( _WIN32 )
+	const int status = _pclose( pipe );
+	const bool success = status == 0;
+#else
+	const int status = pclose( pipe );
+	const bool success = status != -1 && WIFEXITED( status ) && WEXITSTATUS( status ) == 0;
+#endif
+	if ( !success ) throw std::runtime_error( "ot::command_function: " + _command + " failed" );
+
+	double value;
+	if ( !detail::first_number( output, value ) ) throw std::runtime_error( "ot::command_function: no value printed by " + _command );
+	return value;
+}
+
+}
+
+#endif
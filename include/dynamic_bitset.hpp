@@ -0,0 +1,589 @@
+/*
+	Copyright (c) 2012 Charly LERSTEAU
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef OT_DYNAMIC_BITSET_HPP
+#define OT_DYNAMIC_BITSET_HPP
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <iterator>
+#include <stdint.h>
+#include <vector>
+#include "random.hpp"
+
+namespace ot
+{
+
+/*
+	Class: dynamic_bitset
+
+	Binary solution packed in 64-bit words, whose operations work a word at
+	a time where std::vector<bool> works a bit at a time: counting,
+	Hamming distance, crossovers, mutation and weighted sums.
+
+	The bits past size() in the last word are always zero, so that whole
+	words can be counted and compared.
+
+	It has the interface of std::vector<bool> used by the moves and models
+	of incremental.hpp (operator [], size(), value_type), so that it can
+	replace it there.
+*/
+
+class dynamic_bitset
+{
+public:
+	typedef uint64_t    block_type;
+	typedef bool        value_type;
+	typedef bool        const_reference;
+	typedef std::size_t size_type;
+
+	static const std::size_t bits_per_block = 64;
+	static const std::size_t npos = std::size_t( -1 );
+
+	class reference
+	{
+	public:
+		operator bool () const { return ( *_block & _mask ) != 0; }
+		bool operator ~ () const { return ( *_block & _mask ) == 0; }
+
+		reference & operator = ( bool x ) { if ( x ) *_block |= _mask; else *_block &= ~_mask; return *this; }
+		reference & operator = ( const reference & r ) { return *this = bool( r ); }
+		reference & flip() { *_block ^= _mask; return *this; }
+
+	private:
+		friend class dynamic_bitset;
+
+		reference( block_type * block, std::size_t i ) : _block( block ), _mask( block_type( 1 ) << i ) {}
+
+		block_type * _block;
+		block_type   _mask;
+	};
+
+	dynamic_bitset() : _size( 0 ) {}
+	explicit dynamic_bitset( std::size_t n, bool value = false );
+	explicit dynamic_bitset( const std::vector<bool> & x );
+
+	std::size_t size() const { return _size; }
+	bool empty() const { return _size == 0; }
+	void resize( std::size_t n, bool value = false );
+	void clear() { _blocks.clear(); _size = 0; }
+
+	bool operator [] ( std::size_t i ) const { return test( i ); }
+	reference operator [] ( std::size_t i ) { return reference( &_blocks[i / bits_per_block], i % bits_per_block ); }
+
+	bool test( std::size_t i ) const { return ( _blocks[i / bits_per_block] >> ( i % bits_per_block ) ) & 1u; }
+	dynamic_bitset & set( std::size_t i, bool value = true ) { ( *this )[i] = value; return *this; }
+	dynamic_bitset & reset( std::size_t i ) { ( *this )[i] = false; return *this; }
+	dynamic_bitset & flip( std::size_t i ) { _blocks[i / bits_per_block] ^= block_type( 1 ) << ( i % bits_per_block ); return *this; }
+
+	dynamic_bitset & set();
+	dynamic_bitset & reset();
+	dynamic_bitset & flip();
+
+	std::size_t count() const;
+	bool any() const;
+	bool none() const { return !any(); }
+	bool all() const { return count() == _size; }
+
+	std::size_t find_first() const { return find_from( 0 ); }
+	std::size_t find_next( std::size_t i ) const { return find_from( i + 1 ); }
+
+	dynamic_bitset & operator &= ( const dynamic_bitset & x );
+	dynamic_bitset & operator |= ( const dynamic_bitset & x );
+	dynamic_bitset & operator ^= ( const dynamic_bitset & x );
+	dynamic_bitset & operator -= ( const dynamic_bitset & x );
+	dynamic_bitset operator ~ () const { return dynamic_bitset( *this ).flip(); }
+
+	bool operator == ( const dynamic_bitset & x ) const { return _size == x._size && _blocks == x._blocks; }
+	bool operator != ( const dynamic_bitset & x ) const { return !( *this == x ); }
+
+	std::size_t num_blocks() const { return _blocks.size(); }
+	block_type * data() { return _blocks.empty() ? 0 : &_blocks[0]; }
+	const block_type * data() const { return _blocks.empty() ? 0 : &_blocks[0]; }
+
+	// Clears the bits past size() after a direct write of the words.
+	void trim();
+
+	void swap( dynamic_bitset & x ) { _blocks.swap( x._blocks ); std::swap( _size, x._size ); }
+
+private:
+	static std::size_t blocks_for( std::size_t n ) { return ( n + bits_per_block - 1 ) / bits_per_block; }
+
+	std::size_t find_from( std::size_t i ) const;
+
+	std::vector<block_type> _blocks;
+	std::size_t             _size;
+};
+
+inline dynamic_bitset operator & ( const dynamic_bitset & a, const dynamic_bitset & b ) { return dynamic_bitset( a ) &= b; }
+inline dynamic_bitset operator | ( const dynamic_bitset & a, const dynamic_bitset & b ) { return dynamic_bitset( a ) |= b; }
+inline dynamic_bitset operator ^ ( const dynamic_bitset & a, const dynamic_bitset & b ) { return dynamic_bitset( a ) ^= b; }
+inline dynamic_bitset operator - ( const dynamic_bitset & a, const dynamic_bitset & b ) { return dynamic_bitset( a ) -= b; }
+
+inline void swap( dynamic_bitset & a, dynamic_bitset & b ) { a.swap( b ); }
+
+/*
+	Function: hamming_distance
+
+	Number of positions at which a and b differ, by popcount of a ^ b
+	without building it.
+*/
+
+inline std::size_t hamming_distance( const dynamic_bitset & a, const dynamic_bitset & b );
+
+/*
+	Function: count_and
+
+	Number of positions set in both a and b, without building a & b. For
+	instance, with x the chosen sets of a set cover and b the sets which
+	contain an element, the number of chosen sets covering it.
+*/
+
+inline std::size_t count_and( const dynamic_bitset & a, const dynamic_bitset & b );
+
+/*
+	Function: intersects
+
+	Checks if a and b have a common set position; stops at the first one.
+*/
+
+inline bool intersects( const dynamic_bitset & a, const dynamic_bitset & b );
+
+/*
+	Function: dot
+
+	Sum of the weights at the set positions of x, visiting only the set
+	bits. For integer weights, <bit_weights> is faster on dense solutions.
+*/
+
+template<class I>
+typename std::iterator_traits<I>::value_type dot( const dynamic_bitset & x, I weights );
+
+/*
+	Class: bit_weights<T>
+
+	Integer weights stored as bit-planes: plane b holds bit b of each
+	weight, in two's complement, so that a weighted sum of a solution x is
+
+		sum_b 2^b popcount( x & plane_b ),
+
+	with the last plane counted negatively when some weights are negative.
+	The cost is one AND and one popcount per word and per plane, independent
+	of the density of x: knapsack weights up to 2^16 take 17 passes over
+	64-bit words instead of 64 additions per word.
+*/
+
+template<typename T = int64_t>
+class bit_weights
+{
+public:
+	typedef T value_type;
+
+	template<class I>
+	bit_weights( I first, I last );
+
+	T operator () ( const dynamic_bitset & x ) const { return dot( x ); }
+	T dot( const dynamic_bitset & x ) const;
+
+	std::size_t size() const { return _size; }
+	std::size_t planes() const { return _planes.size(); }
+
+private:
+	std::size_t                 _size;
+	bool                        _signed;
+	std::vector<dynamic_bitset> _planes;
+};
+
+/*
+	Function: uniform_crossover
+
+	Children c1 and c2 take each bit from a or b with probability 1/2, c2
+	from the other parent: c1 = (a & m) | (b & ~m) with a random mask m,
+	one engine word per 64 bits. The children may alias the parents.
+*/
+
+template<class G>
+void uniform_crossover( const dynamic_bitset & a, const dynamic_bitset & b, dynamic_bitset & c1, dynamic_bitset & c2, G & g );
+
+/*
+	Function: one_point_crossover
+
+	c1 takes the bits of a before point and those of b from point on, c2
+	the converse; whole words are copied and only the word of point is
+	mixed. Without a point, it is drawn uniformly in [1, size()).
+*/
+
+inline void one_point_crossover( const dynamic_bitset & a, const dynamic_bitset & b, dynamic_bitset & c1, dynamic_bitset & c2, std::size_t point );
+
+template<class G>
+void one_point_crossover( const dynamic_bitset & a, const dynamic_bitset & b, dynamic_bitset & c1, dynamic_bitset & c2, G & g );
+
+/*
+	Function: mutate
+
+	Flips each bit independently with probability rate, and returns the
+	number of flipped bits.
+
+	For rates from 1/16, the flips of a word come from a mask whose bits
+	are set with probability rate, built from the binary expansion of rate
+	with one engine word per digit (16 digits at most): AND with a random
+	word halves the probability of a bit, OR makes it (1 + p) / 2. Lower
+	rates, such as the usual 1/size(), draw the gaps between flips from a
+	geometric distribution instead, which costs one draw per flip.
+*/
+
+template<class G>
+std::size_t mutate( dynamic_bitset & x, double rate, G & g );
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace detail
+{
+
+inline unsigned popcount( uint64_t x )
+{
+#if defined( __GNUC__ )
+	return unsigned( __builtin_popcountll( x ) );
+#else
+	x = x - ( ( x >> 1 ) & UINT64_C(0x5555555555555555) );
+	x = ( x & UINT64_C(0x3333333333333333) ) + ( ( x >> 2 ) & UINT64_C(0x3333333333333333) );
+	x = ( x + ( x >> 4 ) ) & UINT64_C(0x0f0f0f0f0f0f0f0f);
+	return unsigned( ( x * UINT64_C(0x0101010101010101) ) >> 56 );
+#endif
+}
+
+inline unsigned lowest_bit( uint64_t x )
+{
+#if defined( __GNUC__ )
+	return unsigned( __builtin_ctzll( x ) );
+#else
+	unsigned c = 0;
+	for ( ; !( x & 1u ); x >>= 1 ) ++c;
+	return c;
+#endif
+}
+
+}
+
+inline dynamic_bitset::dynamic_bitset( std::size_t n, bool value ) : _blocks( blocks_for( n ), value ? ~block_type( 0 ) : 0 ), _size( n )
+{
+	trim();
+}
+
+inline dynamic_bitset::dynamic_bitset( const std::vector<bool> & x ) : _blocks( blocks_for( x.size() ), 0 ), _size( x.size() )
+{
+	for ( std::size_t i = 0; i < x.size(); ++i )
+	{
+		if ( x[i] ) flip( i );
+	}
+}
+
+inline void dynamic_bitset::resize( std::size_t n, bool value )
+{
+	const std::size_t old = _size;
+	_blocks.resize( blocks_for( n ), value ? ~block_type( 0 ) : 0 );
+	_size = n;
+	if ( value && old < n && old % bits_per_block != 0 )
+	{
+		_blocks[old / bits_per_block] |= ~block_type( 0 ) << ( old % bits_per_block );
+	}
+	trim();
+}
+
+inline void dynamic_bitset::trim()
+{
+	if ( _size % bits_per_block != 0 )
+	{
+		_blocks.back() &= ~( ~block_type( 0 ) << ( _size % bits_per_block ) );
+	}
+}
+
+inline dynamic_bitset & dynamic_bitset::set()
+{
+	std::fill( _blocks.begin(), _blocks.end(), ~block_type( 0 ) );
+	trim();
+	return *this;
+}
+
+inline dynamic_bitset & dynamic_bitset::reset()
+{
+	std::fill( _blocks.begin(), _blocks.end(), block_type( 0 ) );
+	return *this;
+}
+
+inline dynamic_bitset & dynamic_bitset::flip()
+{
+	for ( std::size_t k = 0; k < _blocks.size(); ++k ) _blocks[k] = ~_blocks[k];
+	trim();
+	return *this;
+}
+
+inline std::size_t dynamic_bitset::count() const
+{
+	std::size_t c = 0;
+	for ( std::size_t k = 0; k < _blocks.size(); ++k ) c += detail::popcount( _blocks[k] );
+	return c;
+}
+
+inline bool dynamic_bitset::any() const
+{
+	for ( std::size_t k = 0; k < _blocks.size(); ++k )
+	{
+		if ( _blocks[k] ) return true;
+	}
+	return false;
+}
+
+inline std::size_t dynamic_bitset::find_from( std::size_t i ) const
+{
+	if ( i >= _size ) return npos;
+
+	std::size_t k = i / bits_per_block;
+	block_type w = _blocks[k] & ( ~block_type( 0 ) << ( i % bits_per_block ) );
+	while ( !w )
+	{
+		if ( ++k == _blocks.size() ) return npos;
+		w = _blocks[k];
+	}
+	return k * bits_per_block + detail::lowest_bit( w );
+}
+
+inline dynamic_bitset & dynamic_bitset::operator &= ( const dynamic_bitset & x )
+{
+	assert( _size == x._size );
+	for ( std::size_t k = 0; k < _blocks.size(); ++k ) _blocks[k] &= x._blocks[k];
+	return *this;
+}
+
+inline dynamic_bitset & dynamic_bitset::operator |= ( const dynamic_bitset & x )
+{
+	assert( _size == x._size );
+	for ( std::size_t k = 0; k < _blocks.size(); ++k ) _blocks[k] |= x._blocks[k];
+	return *this;
+}
+
+inline dynamic_bitset & dynamic_bitset::operator ^= ( const dynamic_bitset & x )
+{
+	assert( _size == x._size );
+	for ( std::size_t k = 0; k < _blocks.size(); ++k ) _blocks[k] ^= x._blocks[k];
+	return *this;
+}
+
+inline dynamic_bitset & dynamic_bitset::operator -= ( const dynamic_bitset & x )
+{
+	assert( _size == x._size );
+	for ( std::size_t k = 0; k < _blocks.size(); ++k ) _blocks[k] &= ~x._blocks[k];
+	return *this;
+}
+
+inline std::size_t hamming_distance( const dynamic_bitset & a, const dynamic_bitset & b )
+{
+	assert( a.size() == b.size() );
+	const uint64_t * x = a.data();
+	const uint64_t * y = b.data();
+	std::size_t c = 0;
+	for ( std::size_t k = 0; k < a.num_blocks(); ++k ) c += detail::popcount( x[k] ^ y[k] );
+	return c;
+}
+
+inline std::size_t count_and( const dynamic_bitset & a, const dynamic_bitset & b )
+{
+	assert( a.size() == b.size() );
+	const uint64_t * x = a.data();
+	const uint64_t * y = b.data();
+	std::size_t c = 0;
+	for ( std::size_t k = 0; k < a.num_blocks(); ++k ) c += detail::popcount( x[k] & y[k] );
+	return c;
+}
+
+inline bool intersects( const dynamic_bitset & a, const dynamic_bitset & b )
+{
+	assert( a.size() == b.size() );
+	const uint64_t * x = a.data();
+	const uint64_t * y = b.data();
+	for ( std::size_t k = 0; k < a.num_blocks(); ++k )
+	{
+		if ( x[k] & y[k] ) return true;
+	}
+	return false;
+}
+
+template<class I>
+typename std::iterator_traits<I>::value_type dot( const dynamic_bitset & x, I weights )
+{
+	typedef typename std::iterator_traits<I>::value_type T;
+
+	const uint64_t * p = x.data();
+	T s = T();
+	for ( std::size_t k = 0; k < x.num_blocks(); ++k )
+	{
+		const I w = weights + std::ptrdiff_t( k * dynamic_bitset::bits_per_block );
+		for ( uint64_t b = p[k]; b; b &= b - 1 )
+		{
+			s += w[detail::lowest_bit( b )];
+		}
+	}
+	return s;
+}
+
+template<typename T>
+template<class I>
+bit_weights<T>::bit_weights( I first, I last ) : _size( std::size_t( std::distance( first, last ) ) ), _signed( false )
+{
+	// Planes needed for the largest magnitude, plus a sign plane if needed.
+	uint64_t magnitude = 0;
+	for ( I it = first; it != last; ++it )
+	{
+		const int64_t w = int64_t( *it );
+		if ( w < 0 ) _signed = true;
+		magnitude |= uint64_t( w < 0 ? ~w : w );
+	}
+
+	std::size_t n = 0;
+	while ( n < 64 && ( magnitude >> n ) ) ++n;
+	if ( _signed ) ++n;
+
+	_planes.assign( n, dynamic_bitset( _size ) );
+	std::size_t i = 0;
+	for ( I it = first; it != last; ++it, ++i )
+	{
+		const uint64_t w = uint64_t( int64_t( *it ) );
+		for ( std::size_t b = 0; b < n; ++b )
+		{
+			if ( ( w >> b ) & 1u ) _planes[b].flip( i );
+		}
+	}
+}
+
+template<typename T>
+T bit_weights<T>::dot( const dynamic_bitset & x ) const
+{
+	assert( x.size() == _size );
+	const std::size_t n = _planes.size();
+	int64_t s = 0;
+	for ( std::size_t b = 0; b < n; ++b )
+	{
+		const int64_t c = int64_t( count_and( x, _planes[b] ) );
+		if ( _signed && b + 1 == n ) s -= int64_t( uint64_t( c ) << b );
+		else                         s += int64_t( uint64_t( c ) << b );
+	}
+	return T( s );
+}
+
+template<class G>
+void uniform_crossover( const dynamic_bitset & a, const dynamic_bitset & b, dynamic_bitset & c1, dynamic_bitset & c2, G & g )
+{
+	assert( a.size() == b.size() );
+	c1.resize( a.size() );
+	c2.resize( a.size() );
+
+	// Taken after the resizes, which may move a parent aliased by a child.
+	// Each output word only depends on the input words at the same index,
+	// which are read before being written.
+	const uint64_t * x = a.data();
+	const uint64_t * y = b.data();
+	uint64_t * p = c1.data();
+	uint64_t * q = c2.data();
+	for ( std::size_t k = 0; k < a.num_blocks(); ++k )
+	{
+		const uint64_t m  = detail::generate_word64( g );
+		const uint64_t xk = x[k];
+		const uint64_t yk = y[k];
+		p[k] = ( xk & m ) | ( yk & ~m );
+		q[k] = ( yk & m ) | ( xk & ~m );
+	}
+}
+
+inline void one_point_crossover( const dynamic_bitset & a, const dynamic_bitset & b, dynamic_bitset & c1, dynamic_bitset & c2, std::size_t point )
+{
+	assert( a.size() == b.size() && point <= a.size() );
+	c1.resize( a.size() );
+	c2.resize( a.size() );
+
+	// As in uniform_crossover, parents may be aliased by the children.
+	const uint64_t * x = a.data();
+	const uint64_t * y = b.data();
+	uint64_t * p = c1.data();
+	uint64_t * q = c2.data();
+	const std::size_t s = point / dynamic_bitset::bits_per_block;
+	for ( std::size_t k = 0; k < a.num_blocks(); ++k )
+	{
+		const uint64_t m  = ( k < s ) ? 0 : ( k > s ) ? ~uint64_t( 0 ) : ~uint64_t( 0 ) << ( point % dynamic_bitset::bits_per_block );
+		const uint64_t xk = x[k];
+		const uint64_t yk = y[k];
+		p[k] = ( xk & ~m ) | ( yk & m );
+		q[k] = ( yk & ~m ) | ( xk & m );
+	}
+}
+
+template<class G>
+void one_point_crossover( const dynamic_bitset & a, const dynamic_bitset & b, dynamic_bitset & c1, dynamic_bitset & c2, G & g )
+{
+	const std::size_t point = a.size() < 2 ? 0 : uniform_int_distribution<std::size_t>( 1, a.size() - 1 )( g );
+	one_point_crossover( a, b, c1, c2, point );
+}
+
+template<class G>
+std::size_t mutate( dynamic_bitset & x, double rate, G & g )
+{
+	if ( !( rate > 0.0 ) || x.empty() ) return 0;
+
+	std::size_t flips = 0;
+	uint64_t * p = x.data();
+
+	if ( rate >= 1.0 / 16.0 )
+	{
+		// Digits of rate in 16-bit fixed point, from the lowest set one.
+		const uint64_t r = rate >= 1.0 ? UINT64_C(0x10000) : uint64_t( rate * 65536.0 + 0.5 );
+		const unsigned low = detail::lowest_bit( r );
+		const std::size_t tail = x.size() % dynamic_bitset::bits_per_block;
+
+		for ( std::size_t k = 0; k < x.num_blocks(); ++k )
+		{
+			uint64_t m = ( r >> 16 ) ? ~uint64_t( 0 ) : 0;
+			for ( unsigned d = low; d < 16; ++d )
+			{
+				const uint64_t w = detail::generate_word64( g );
+				m = ( ( r >> d ) & 1u ) ? ( m | w ) : ( m & w );
+			}
+			if ( tail != 0 && k + 1 == x.num_blocks() ) m &= ~( ~uint64_t( 0 ) << tail );
+			p[k] ^= m;
+			flips += detail::popcount( m );
+		}
+		return flips;
+	}
+
+	// Gap before the next flip: geometric, floor( log(u) / log(1 - rate) ).
+	const double scale = 1.0 / std::log( 1.0 - rate );
+	const uniform_real_distribution<double> uniform;
+	for ( std::size_t i = 0; ; ++i )
+	{
+		const double u = 1.0 - uniform( g );
+		const double gap = std::floor( std::log( u ) * scale );
+		if ( gap >= double( x.size() - i ) ) break;
+		i += std::size_t( gap );
+		x.flip( i );
+		++flips;
+	}
+	return flips;
+}
+
+}
+
+#endif
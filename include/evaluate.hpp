@@ -0,0 +1,118 @@
+/*
+	Copyright (c) 2012 Charly LERSTEAU
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef OT_EVALUATE_HPP
+#define OT_EVALUATE_HPP
+
+#if !( __cplusplus > 201100L || __GXX_EXPERIMENTAL_CXX0X__ )
+#error "evaluate.hpp requires C++11."
+#endif
+
+#include <cstddef>
+#include <iterator>
+#include <utility>
+#include "thread_pool.hpp"
+
+namespace ot
+{
+
+/*
+	Function: evaluate
+
+	Evaluates the solutions [first, last) with f and writes the results to
+	out.
+
+	If f provides a batch overload f( first, last, out ), it is called
+	directly; otherwise f is called once per solution. With a thread pool,
+	the range is split into chunks evaluated in parallel, each chunk with
+	the batch overload when there is one; f is then called concurrently
+	and must be thread-safe. Both iterators must be random access.
+
+	Parameters:
+		pool - Thread pool (optional).
+		f - Objective function.
+		first, last - Range of solutions.
+		out - Beginning of the results.
+		chunk - Solutions per task, 0 for an automatic size.
+*/
+
+template<class F, class I, class O>
+void evaluate( F & f, I first, I last, O out );
+
+template<class F, class I, class O>
+void evaluate( thread_pool & pool, F & f, I first, I last, O out, std::size_t chunk = 0 );
+
+/*
+	Struct: has_batch_evaluation<F, I, O>
+
+	True if f( first, last, out ) is a valid call.
+*/
+
+template<class F, class I, class O>
+struct has_batch_evaluation;
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace detail
+{
+
+template<class F, class I, class O>
+auto evaluate_batch( F & f, I first, I last, O out, int ) -> decltype( f( first, last, out ), void() )
+{
+	f( first, last, out );
+}
+
+template<class F, class I, class O>
+void evaluate_batch( F & f, I first, I last, O out, long )
+{
+	for ( ; first != last; ++first, ++out ) *out = f( *first );
+}
+
+template<class F, class I, class O>
+auto has_batch_evaluation_test( int ) -> decltype( std::declval<F &>()( std::declval<I>(), std::declval<I>(), std::declval<O>() ), char() );
+
+template<class F, class I, class O>
+long has_batch_evaluation_test( long );
+
+}
+
+template<class F, class I, class O>
+struct has_batch_evaluation
+{
+	static const bool value = sizeof( detail::has_batch_evaluation_test<F, I, O>( 0 ) ) == sizeof( char );
+};
+
+template<class F, class I, class O>
+void evaluate( F & f, I first, I last, O out )
+{
+	detail::evaluate_batch( f, first, last, out, 0 );
+}
+
+template<class F, class I, class O>
+void evaluate( thread_pool & pool, F & f, I first, I last, O out, std::size_t chunk )
+{
+	typedef typename std::iterator_traits<I>::difference_type difference_type;
+
+	pool.parallel_for( difference_type( 0 ), last - first, [&f, first, out] ( difference_type begin, difference_type end )
+	{
+		detail::evaluate_batch( f, first + begin, first + end, out + begin, 0 );
+	}, chunk );
+}
+
+}
+
+#endif
@@ -0,0 +1,387 @@
+/*
+	Copyright (c) 2012 Charly LERSTEAU
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef OT_EXPRESSION_HPP
+#define OT_EXPRESSION_HPP
+
+#include <cassert>
+#include <cstddef>
+#include <limits>
+#include "functional.hpp"
+#include "span.hpp"
+
+namespace ot
+{
+
+/*
+	About: Expression templates
+
+	Elementwise arithmetic on vectors without temporaries: operators on
+	views build a lazy expression, whose elements are computed by the
+	functors of functional.hpp, and the whole expression is evaluated in a
+	single loop when it is assigned.
+
+	Views wrap std::vector, std::valarray, arrays or pointers with <view>;
+	scalars mix with views. For example, the mutation of differential
+	evolution is written
+
+	> ot::view( y ) = ot::view( a ) + w * ( ot::view( b ) - ot::view( c ) );
+
+	or, to resize y:
+
+	> ot::assign( y, ot::view( a ) + w * ( ot::view( b ) - ot::view( c ) ) );
+
+	The operands of an expression must have the same size. Expressions hold
+	views, not copies: the viewed containers must outlive them.
+*/
+
+/*
+	Class: expression<E>
+
+	Base of the expressions (CRTP).
+*/
+
+template<class E>
+struct expression
+{
+	const E & self() const { return static_cast<const E &>( *this ); }
+};
+
+/*
+	Class: vector_view<T>
+
+	Expression of the elements of a contiguous sequence, which may be
+	assigned an expression if T is not const.
+*/
+
+template<typename T>
+class vector_view;
+
+/*
+	Class: scalar_expression<T>
+
+	Expression whose elements all equal a value.
+*/
+
+template<typename T>
+class scalar_expression;
+
+/*
+	Class: unary_expression<F, E>
+
+	Expression of the elements f( e[i] ).
+*/
+
+template<class F, class E>
+class unary_expression;
+
+/*
+	Class: binary_expression<F, L, R>
+
+	Expression of the elements f( l[i], r[i] ).
+*/
+
+template<class F, class L, class R>
+class binary_expression;
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace detail
+{
+
+template<bool B, typename T = void>
+struct expression_enable_if {};
+
+template<typename T>
+struct expression_enable_if<true, T> { typedef T type; };
+
+template<typename T>
+struct expression_remove_const { typedef T type; };
+
+template<typename T>
+struct expression_remove_const<const T> { typedef T type; };
+
+// Scalars are arithmetic types, and other types with numeric limits.
+template<typename T, typename R>
+struct enable_if_scalar : expression_enable_if<std::numeric_limits<T>::is_specialized, R> {};
+
+template<class F, typename T>
+struct unary_result
+{
+#if __cplusplus > 201100L || __GXX_EXPERIMENTAL_CXX0X__
+	typedef decltype( std::declval<const F &>()( std::declval<T>() ) ) type;
+#else
+	typedef typename F::result_type type;
+#endif
+};
+
+template<class F, typename T1, typename T2>
+struct binary_result
+{
+#if __cplusplus > 201100L || __GXX_EXPERIMENTAL_CXX0X__
+	typedef decltype( std::declval<const F &>()( std::declval<T1>(), std::declval<T2>() ) ) type;
+#else
+	typedef typename F::result_type type;
+#endif
+};
+
+}
+
+template<typename T>
+class vector_view : public expression< vector_view<T> >
+{
+public:
+	typedef typename detail::expression_remove_const<T>::type value_type;
+
+	explicit vector_view( span<T> s ) : _span( s ) {}
+	vector_view( const vector_view & v ) : _span( v._span ) {}
+
+	const T & operator [] ( std::size_t i ) const { return _span[i]; }
+	std::size_t size() const { return _span.size(); }
+	T * data() const { return _span.data(); }
+
+	// Assigns the elements, as for any expression.
+	vector_view & operator = ( const vector_view & v ) { return assign( v ); }
+
+	template<class E>
+	vector_view & operator = ( const expression<E> & e ) { return assign( e.self() ); }
+
+	vector_view & operator = ( const value_type & x )
+	{
+		for ( std::size_t i = 0; i < _span.size(); ++i ) _span[i] = x;
+		return *this;
+	}
+
+	template<class E>
+	vector_view & operator += ( const expression<E> & e ) { return *this = *this + e; }
+
+	template<class E>
+	vector_view & operator -= ( const expression<E> & e ) { return *this = *this - e; }
+
+	template<class E>
+	vector_view & operator *= ( const expression<E> & e ) { return *this = *this * e; }
+
+	template<class E>
+	vector_view & operator /= ( const expression<E> & e ) { return *this = *this / e; }
+
+	vector_view & operator += ( const value_type & x ) { return *this = *this + x; }
+	vector_view & operator -= ( const value_type & x ) { return *this = *this - x; }
+	vector_view & operator *= ( const value_type & x ) { return *this = *this * x; }
+	vector_view & operator /= ( const value_type & x ) { return *this = *this / x; }
+
+private:
+	// The single loop of an expression, which the compiler can vectorize.
+	template<class E>
+	vector_view & assign( const E & e )
+	{
+		assert( e.size() == _span.size() );
+		T * const p = _span.data();
+		const std::size_t n = _span.size();
+		for ( std::size_t i = 0; i < n; ++i ) p[i] = e[i];
+		return *this;
+	}
+
+	span<T> _span;
+};
+
+template<typename T>
+class scalar_expression : public expression< scalar_expression<T> >
+{
+public:
+	typedef T value_type;
+
+	explicit scalar_expression( const T & x ) : _value( x ) {}
+
+	const T & operator [] ( std::size_t ) const { return _value; }
+	std::size_t size() const { return 0; } // Takes the size of the other operand.
+
+private:
+	T _value;
+};
+
+template<class F, class E>
+class unary_expression : public expression< unary_expression<F, E> >
+{
+public:
+	typedef typename detail::unary_result<F, typename E::value_type>::type value_type;
+
+	unary_expression( const E & e, const F & f = F() ) : _e( e ), _f( f ) {}
+
+	value_type operator [] ( std::size_t i ) const { return _f( _e[i] ); }
+	std::size_t size() const { return _e.size(); }
+
+private:
+	E _e;
+	F _f;
+};
+
+template<class F, class L, class R>
+class binary_expression : public expression< binary_expression<F, L, R> >
+{
+public:
+	typedef typename detail::binary_result<F, typename L::value_type, typename R::value_type>::type value_type;
+
+	binary_expression( const L & l, const R & r, const F & f = F() ) : _l( l ), _r( r ), _f( f )
+	{
+		assert( l.size() == 0 || r.size() == 0 || l.size() == r.size() );
+	}
+
+	value_type operator [] ( std::size_t i ) const { return _f( _l[i], _r[i] ); }
+	std::size_t size() const { return _l.size() > 0 ? _l.size() : _r.size(); }
+
+private:
+	L _l;
+	R _r;
+	F _f;
+};
+
+/*
+	Function: view
+
+	View of a contiguous container, of an array, or of n elements from a
+	pointer.
+*/
+
+template<class C>
+inline vector_view<typename C::value_type> view( C & c )
+{
+	return vector_view<typename C::value_type>( span<typename C::value_type>( c ) );
+}
+
+template<class C>
+inline vector_view<const typename C::value_type> view( const C & c )
+{
+	return vector_view<const typename C::value_type>( span<const typename C::value_type>( c ) );
+}
+
+template<typename T, std::size_t N>
+inline vector_view<T> view( T (&a)[N] )
+{
+	return vector_view<T>( span<T>( a, N ) );
+}
+
+template<typename T, std::size_t N>
+inline vector_view<const T> view( const T (&a)[N] )
+{
+	return vector_view<const T>( span<const T>( a, N ) );
+}
+
+template<typename T>
+inline vector_view<T> view( T * p, std::size_t n )
+{
+	return vector_view<T>( span<T>( p, n ) );
+}
+
+template<typename T>
+inline vector_view<T> view( span<T> s )
+{
+	return vector_view<T>( s );
+}
+
+/*
+	Function: elementwise
+
+	Expression of any unary or binary functor applied elementwise.
+*/
+
+template<class F, class E>
+inline unary_expression<F, E> elementwise( F f, const expression<E> & e )
+{
+	return unary_expression<F, E>( e.self(), f );
+}
+
+template<class F, class L, class R>
+inline binary_expression<F, L, R> elementwise( F f, const expression<L> & l, const expression<R> & r )
+{
+	return binary_expression<F, L, R>( l.self(), r.self(), f );
+}
+
+/*
+	Function: assign
+
+	Resizes a container to the size of an expression and evaluates it into
+	the container.
+*/
+
+template<class C, class E>
+inline C & assign( C & c, const expression<E> & e )
+{
+	if ( c.size() != e.self().size() ) c.resize( e.self().size() );
+	view( c ) = e;
+	return c;
+}
+
+/*
+	Function: sum
+
+	Sum of the elements of an expression.
+*/
+
+template<class E>
+inline typename E::value_type sum( const expression<E> & e )
+{
+	typename E::value_type s = typename E::value_type();
+	const std::size_t n = e.self().size();
+	for ( std::size_t i = 0; i < n; ++i ) s += e.self()[i];
+	return s;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+template<class E>
+inline unary_expression<negate<typename E::value_type>, E> operator - ( const expression<E> & e )
+{
+	return unary_expression<negate<typename E::value_type>, E>( e.self() );
+}
+
+#define __ot_expression_operator(OP,FUNCTOR)                                                          \
+template<class L, class R>                                                                            \
+inline binary_expression<FUNCTOR<typename L::value_type, typename R::value_type>, L, R>               \
+operator OP ( const expression<L> & l, const expression<R> & r )                                      \
+{                                                                                                     \
+	return binary_expression<FUNCTOR<typename L::value_type, typename R::value_type>, L, R>(          \
+		l.self(), r.self() );                                                                         \
+}                                                                                                     \
+                                                                                                      \
+template<typename T, class R>                                                                         \
+inline typename detail::enable_if_scalar<T,                                                           \
+	binary_expression<FUNCTOR<T, typename R::value_type>, scalar_expression<T>, R> >::type            \
+operator OP ( const T & x, const expression<R> & r )                                                  \
+{                                                                                                     \
+	return binary_expression<FUNCTOR<T, typename R::value_type>, scalar_expression<T>, R>(            \
+		scalar_expression<T>( x ), r.self() );                                                        \
+}                                                                                                     \
+                                                                                                      \
+template<class L, typename T>                                                                         \
+inline typename detail::enable_if_scalar<T,                                                           \
+	binary_expression<FUNCTOR<typename L::value_type, T>, L, scalar_expression<T> > >::type           \
+operator OP ( const expression<L> & l, const T & x )                                                  \
+{                                                                                                     \
+	return binary_expression<FUNCTOR<typename L::value_type, T>, L, scalar_expression<T> >(           \
+		l.self(), scalar_expression<T>( x ) );                                                        \
+}
+
+__ot_expression_operator(+,plus)
+__ot_expression_operator(-,minus)
+__ot_expression_operator(*,multiplies)
+__ot_expression_operator(/,divides)
+
+#undef __ot_expression_operator
+
+}
+
+#endif
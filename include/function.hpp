@@ -21,9 +21,493 @@
 #include <iostream>
 #include <typeinfo>
 
+#if __cplusplus > 201100L || __GXX_EXPERIMENTAL_CXX0X__
+#include <cstddef>
+#include <cstring>
+#include <functional>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#endif
+
 namespace ot
 {
 
+#if __cplusplus > 201100L || __GXX_EXPERIMENTAL_CXX0X__
+
+// Size in bytes of the buffer in which <function> stores small callables.
+#ifndef OT_FUNCTION_BUFFER_SIZE
+#define OT_FUNCTION_BUFFER_SIZE ( 4 * sizeof( void * ) )
+#endif
+
+namespace detail
+{
+
+enum class function_operation { destroy, move, copy };
+
+// Calls f, discarding the result when R is void.
+template<typename R>
+struct function_invoker
+{
+	template<class F, typename... A>
+	static R call( F & f, A &&... a ) { return f( std::forward<A>( a )... ); }
+};
+
+template<>
+struct function_invoker<void>
+{
+	template<class F, typename... A>
+	static void call( F & f, A &&... a ) { f( std::forward<A>( a )... ); }
+};
+
+// Checks if F can be called with Args and its result converted to R.
+template<class F, typename R, typename... Args>
+class is_callable
+{
+	template<class G>
+	static auto test( int ) -> decltype( std::declval<G &>()( std::declval<Args>()... ), std::true_type() );
+	template<class G>
+	static std::false_type test( ... );
+
+	template<class G, bool = decltype( test<G>( 0 ) )::value>
+	struct convertible : std::false_type {};
+	template<class G>
+	struct convertible<G, true> : std::integral_constant<bool, std::is_void<R>::value
+		|| std::is_convertible<decltype( std::declval<G &>()( std::declval<Args>()... ) ), R>::value> {};
+
+public:
+	static const bool value = convertible<F>::value;
+};
+
+template<class F>
+inline bool is_null_function( const F & ) { return false; }
+
+template<typename R, typename... Args>
+inline bool is_null_function( R (* const & f)( Args... ) ) { return f == nullptr; }
+
+}
+
+/*
+	Class: basic_function<R(Args...), Size>
+
+	A callable function container.
+
+	Callables of at most Size bytes that are nothrow movable are stored in
+	an inline buffer, larger ones on the heap. Calls go through a single
+	trampoline pointer without any branch; an empty function has a
+	trampoline throwing std::bad_function_call. Arguments are forwarded,
+	not copied. Move-only callables are supported, in which case copying
+	the function throws std::logic_error.
+
+	For compatibility, a pointer to an object is stored without ownership
+	and calls the operator () of the object, and <from_method> builds a
+	function calling a given method of an object.
+*/
+
+template<typename Signature, std::size_t Size = OT_FUNCTION_BUFFER_SIZE>
+class basic_function;
+
+template<typename R, typename... Args, std::size_t Size>
+class basic_function<R(Args...), Size>
+{
+	typedef R (*invoke_type)( void *, Args &&... );
+	typedef void (*manage_type)( detail::function_operation, void *, void * );
+
+	template<class F>
+	struct is_function_argument : std::integral_constant<bool,
+		!std::is_base_of<basic_function, typename std::decay<F>::type>::value
+		&& !( std::is_pointer<typename std::decay<F>::type>::value
+			&& std::is_class<typename std::remove_pointer<typename std::decay<F>::type>::type>::value )
+		&& detail::is_callable<typename std::decay<F>::type, R, Args...>::value> {};
+
+public:
+	typedef R result_type;
+
+	static const std::size_t buffer_size = Size;
+
+	basic_function() noexcept : _invoke( &empty_invoke ), _manage( nullptr ) {}
+	basic_function( std::nullptr_t ) noexcept : _invoke( &empty_invoke ), _manage( nullptr ) {}
+
+	template<class F, typename = typename std::enable_if<is_function_argument<F>::value>::type>
+	basic_function( F && f ) : _invoke( &empty_invoke ), _manage( nullptr )
+	{
+		typedef typename std::decay<F>::type G;
+		if ( detail::is_null_function( f ) ) return;
+		handler<G>::create( _storage, std::forward<F>( f ) );
+		_invoke = &invoke<G>;
+		_manage = handler<G>::manager();
+	}
+
+	template<class C, typename = typename std::enable_if<std::is_class<C>::value>::type>
+	basic_function( C * object ) : _invoke( &object_invoke<C> ), _manage( nullptr )
+	{
+		*reinterpret_cast<C **>( _storage ) = object;
+	}
+
+	basic_function( const basic_function & f ) : _invoke( f._invoke ), _manage( f._manage )
+	{
+		if ( _manage )
+		{
+			_manage( detail::function_operation::copy, _storage, const_cast<unsigned char *>( f._storage ) );
+		}
+		else
+		{
+			std::memcpy( _storage, f._storage, Size );
+		}
+	}
+
+	basic_function( basic_function && f ) noexcept : _invoke( f._invoke ), _manage( f._manage )
+	{
+		steal( f );
+	}
+
+	~basic_function()
+	{
+		if ( _manage ) _manage( detail::function_operation::destroy, _storage, nullptr );
+	}
+
+	basic_function & operator = ( const basic_function & f )
+	{
+		if ( this != &f ) basic_function( f ).swap( *this );
+		return *this;
+	}
+
+	basic_function & operator = ( basic_function && f ) noexcept
+	{
+		if ( this != &f )
+		{
+			reset();
+			_invoke = f._invoke;
+			_manage = f._manage;
+			steal( f );
+		}
+		return *this;
+	}
+
+	basic_function & operator = ( std::nullptr_t ) noexcept
+	{
+		reset();
+		return *this;
+	}
+
+	R operator () ( Args... args ) const
+	{
+		return _invoke( const_cast<unsigned char *>( _storage ), std::forward<Args>( args )... );
+	}
+
+	explicit operator bool () const noexcept { return _invoke != &empty_invoke; }
+
+	void swap( basic_function & f ) noexcept
+	{
+		basic_function t( std::move( f ) );
+		f = std::move( *this );
+		*this = std::move( t );
+	}
+
+	template<class C, R (C::*Method)(Args...)>
+	static basic_function from_method( C * object )
+	{
+		return basic_function( object, &method_invoke<C, Method> );
+	}
+
+	template<class C, R (C::*Method)(Args...) const>
+	static basic_function from_method( C * object )
+	{
+		return basic_function( object, &method_invoke_const<C, Method> );
+	}
+
+private:
+	template<class C>
+	basic_function( C * object, invoke_type f ) : _invoke( f ), _manage( nullptr )
+	{
+		*reinterpret_cast<C **>( _storage ) = object;
+	}
+
+	void reset() noexcept
+	{
+		if ( _manage ) _manage( detail::function_operation::destroy, _storage, nullptr );
+		_invoke = &empty_invoke;
+		_manage = nullptr;
+	}
+
+	// Takes the target of f, whose trampolines were already copied, and empties f.
+	void steal( basic_function & f ) noexcept
+	{
+		if ( _manage )
+		{
+			_manage( detail::function_operation::move, _storage, f._storage );
+		}
+		else
+		{
+			std::memcpy( _storage, f._storage, Size );
+		}
+		f._invoke = &empty_invoke;
+		f._manage = nullptr;
+	}
+
+	// Storage policy of a callable of type F.
+	template<class F, bool Inline = ( sizeof( F ) <= Size
+		&& alignof( F ) <= alignof( std::max_align_t )
+		&& std::is_nothrow_move_constructible<F>::value )>
+	struct handler
+	{
+		static F * get( void * s ) { return static_cast<F *>( s ); }
+
+		// Trivial targets are relocated by copying the whole buffer, which is cleared first.
+		template<class G>
+		static void create( void * s, G && g )
+		{
+			if ( !manager() ) std::memset( s, 0, Size );
+			::new ( s ) F( std::forward<G>( g ) );
+		}
+
+		// Trivial callables (function pointers, small captureless lambdas...) are copied with memcpy.
+		static manage_type manager()
+		{
+			return std::is_trivially_copyable<F>::value && std::is_trivially_destructible<F>::value ? nullptr : &manage;
+		}
+
+		static void manage( detail::function_operation op, void * dst, void * src )
+		{
+			switch ( op )
+			{
+			case detail::function_operation::destroy:
+				get( dst )->~F();
+				break;
+			case detail::function_operation::move:
+				::new ( dst ) F( std::move( *get( src ) ) );
+				get( src )->~F();
+				break;
+			case detail::function_operation::copy:
+				copy( dst, *get( src ), std::is_copy_constructible<F>() );
+				break;
+			}
+		}
+
+		static void copy( void * dst, const F & f, std::true_type ) { ::new ( dst ) F( f ); }
+		static void copy( void *, const F &, std::false_type ) { throw std::logic_error( "ot::function: the callable is not copyable" ); }
+	};
+
+	template<class F>
+	struct handler<F, false>
+	{
+		static F * get( void * s ) { return *static_cast<F **>( s ); }
+
+		template<class G>
+		static void create( void * s, G && g ) { *static_cast<F **>( s ) = new F( std::forward<G>( g ) ); }
+
+		static manage_type manager() { return &manage; }
+
+		static void manage( detail::function_operation op, void * dst, void * src )
+		{
+			switch ( op )
+			{
+			case detail::function_operation::destroy:
+				delete get( dst );
+				break;
+			case detail::function_operation::move:
+				*static_cast<F **>( dst ) = get( src );
+				break;
+			case detail::function_operation::copy:
+				*static_cast<F **>( dst ) = clone( *get( src ), std::is_copy_constructible<F>() );
+				break;
+			}
+		}
+
+		static F * clone( const F & f, std::true_type ) { return new F( f ); }
+		static F * clone( const F &, std::false_type ) { throw std::logic_error( "ot::function: the callable is not copyable" ); }
+	};
+
+	template<class F>
+	static R invoke( void * s, Args &&... args )
+	{
+		return detail::function_invoker<R>::call( *handler<F>::get( s ), std::forward<Args>( args )... );
+	}
+
+	template<class C>
+	static R object_invoke( void * s, Args &&... args )
+	{
+		return detail::function_invoker<R>::call( **static_cast<C **>( s ), std::forward<Args>( args )... );
+	}
+
+	template<class C, R (C::*Method)(Args...)>
+	static R method_invoke( void * s, Args &&... args )
+	{
+		return ( ( *static_cast<C **>( s ) ) ->* Method )( std::forward<Args>( args )... );
+	}
+
+	template<class C, R (C::*Method)(Args...) const>
+	static R method_invoke_const( void * s, Args &&... args )
+	{
+		return ( ( *static_cast<C **>( s ) ) ->* Method )( std::forward<Args>( args )... );
+	}
+
+	static R empty_invoke( void *, Args &&... )
+	{
+		throw std::bad_function_call();
+	}
+
+	static_assert( Size >= sizeof( void * ), "ot::basic_function: the buffer must hold at least a pointer" );
+
+	invoke_type _invoke;
+	manage_type _manage;
+	alignas( std::max_align_t ) unsigned char _storage[Size];
+};
+
+/*
+	Class: function<R(Args...)>
+
+	A <basic_function> with a buffer of OT_FUNCTION_BUFFER_SIZE bytes.
+	The former spelling function<R, T1, ..., TN> is still accepted.
+*/
+
+template<typename R, typename... Args>
+class function : public basic_function<R(Args...)>
+{
+public:
+	typedef basic_function<R(Args...)> base_type;
+	using base_type::base_type;
+
+	function() noexcept {}
+	function( const base_type & f ) : base_type( f ) {}
+	function( base_type && f ) noexcept : base_type( std::move( f ) ) {}
+};
+
+template<typename R, typename... Args>
+class function<R(Args...)> : public basic_function<R(Args...)>
+{
+public:
+	typedef basic_function<R(Args...)> base_type;
+	using base_type::base_type;
+
+	function() noexcept {}
+	function( const base_type & f ) : base_type( f ) {}
+	function( base_type && f ) noexcept : base_type( std::move( f ) ) {}
+};
+
+/*
+	Class: function_ref<R(Args...)>
+
+	A non-owning reference to a callable, made of two words: a pointer to
+	the callable (or the function pointer itself) and a thunk calling it.
+	Calls cost one indirect call, without any branch.
+
+	The referenced callable must outlive the function_ref, which is meant
+	to be passed by value as a parameter for callbacks called in hot loops.
+*/
+
+template<typename Signature>
+class function_ref;
+
+template<typename R, typename... Args>
+class function_ref<R(Args...)>
+{
+	union storage
+	{
+		void * object;
+		void (*function)();
+	};
+
+	typedef R (*thunk_type)( storage, Args &&... );
+
+	template<class F>
+	struct is_function_pointer : std::integral_constant<bool,
+		std::is_pointer<typename std::decay<F>::type>::value
+		&& std::is_function<typename std::remove_pointer<typename std::decay<F>::type>::type>::value> {};
+
+	template<class F>
+	struct is_object_argument : std::integral_constant<bool,
+		!std::is_same<typename std::decay<F>::type, function_ref>::value
+		&& !is_function_pointer<F>::value
+		&& detail::is_callable<typename std::remove_reference<F>::type, R, Args...>::value> {};
+
+public:
+	typedef R result_type;
+
+	template<class F, typename = typename std::enable_if<is_function_pointer<F>::value
+		&& detail::is_callable<typename std::decay<F>::type, R, Args...>::value>::type, typename = void>
+	function_ref( F && f ) noexcept : _thunk( &function_thunk<typename std::decay<F>::type> )
+	{
+		_storage.function = reinterpret_cast<void (*)()>( static_cast<typename std::decay<F>::type>( f ) );
+	}
+
+	template<class F, typename = typename std::enable_if<is_object_argument<F>::value>::type>
+	function_ref( F && f ) noexcept : _thunk( &object_thunk<typename std::remove_reference<F>::type> )
+	{
+		_storage.object = const_cast<void *>( static_cast<const void *>( std::addressof( f ) ) );
+	}
+
+	R operator () ( Args... args ) const
+	{
+		return _thunk( _storage, std::forward<Args>( args )... );
+	}
+
+	template<class C, R (C::*Method)(Args...)>
+	static function_ref from_method( C * object ) noexcept
+	{
+		return function_ref( object, &method_thunk<C, Method> );
+	}
+
+	template<class C, R (C::*Method)(Args...) const>
+	static function_ref from_method( const C * object ) noexcept
+	{
+		return function_ref( const_cast<C *>( object ), &method_thunk_const<C, Method> );
+	}
+
+private:
+	function_ref( void * object, thunk_type thunk ) noexcept : _thunk( thunk )
+	{
+		_storage.object = object;
+	}
+
+	template<class F>
+	static R function_thunk( storage s, Args &&... args )
+	{
+		return detail::function_invoker<R>::call( *reinterpret_cast<F>( s.function ), std::forward<Args>( args )... );
+	}
+
+	template<class F>
+	static R object_thunk( storage s, Args &&... args )
+	{
+		return detail::function_invoker<R>::call( *static_cast<F *>( s.object ), std::forward<Args>( args )... );
+	}
+
+	template<class C, R (C::*Method)(Args...)>
+	static R method_thunk( storage s, Args &&... args )
+	{
+		return ( static_cast<C *>( s.object ) ->* Method )( std::forward<Args>( args )... );
+	}
+
+	template<class C, R (C::*Method)(Args...) const>
+	static R method_thunk_const( storage s, Args &&... args )
+	{
+		return ( static_cast<const C *>( s.object ) ->* Method )( std::forward<Args>( args )... );
+	}
+
+	storage    _storage;
+	thunk_type _thunk;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+template<typename R, typename... Args, std::size_t Size>
+inline std::ostream & operator << ( std::ostream & os, const basic_function<R(Args...), Size> & )
+{
+	const char * names[] = { typeid(Args).name()..., 0 };
+
+	os << typeid(R).name() << '(';
+	for ( std::size_t i = 0; i < sizeof...(Args); ++i )
+	{
+		if ( i > 0 ) os << ',';
+		os << names[i];
+	}
+	os << ')';
+	return os;
+}
+
+#else
+
 /*
 	Class: function<R, T1, ..., AN>
 	A callable function container.
@@ -343,6 +827,8 @@ inline std::ostream & operator << ( std::ostream & os, const function<R, T1, T2,
 	return os;
 }
 
+#endif
+
 }
 
 #endif
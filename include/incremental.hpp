@@ -0,0 +1,378 @@
+/*
+	Copyright (c) 2012 Charly LERSTEAU
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef OT_INCREMENTAL_HPP
+#define OT_INCREMENTAL_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+#include "function.hpp"
+
+namespace ot
+{
+
+/*
+	About: Delta evaluation
+
+	Local searches evaluate many moves of a solution and apply few of
+	them. An <incremental_state> holds a solution with its objective value
+	and asks a model for the value after a move, which most models compute
+	in O(1) instead of a full evaluation.
+
+	A model defines:
+		- solution_type and value_type,
+		- value_type evaluate( const solution_type & x ) const,
+		- value_type evaluate_move( const solution_type & x, value_type v, const Move & m ) const,
+		  the value of x after the move m, v being the value of x,
+		- void apply( solution_type & x, const Move & m ), to apply a move and
+		  update the auxiliary data of the model, if any.
+
+	Models may derive from <delta_model>, whose apply() calls <apply_move>.
+*/
+
+/*
+	Struct: bit_flip
+
+	Move which negates the bit index of a binary solution.
+*/
+
+struct bit_flip
+{
+	std::size_t index;
+
+	explicit bit_flip( std::size_t i = 0 ) : index( i ) {}
+};
+
+/*
+	Struct: swap_move
+
+	Move which exchanges the elements at positions first and second.
+*/
+
+struct swap_move
+{
+	std::size_t first;
+	std::size_t second;
+
+	swap_move( std::size_t i = 0, std::size_t j = 0 ) : first( i ), second( j ) {}
+};
+
+/*
+	Struct: insert_move
+
+	Move which removes the element at position from and reinserts it so
+	that it ends at position to, shifting the elements in between.
+*/
+
+struct insert_move
+{
+	std::size_t from;
+	std::size_t to;
+
+	insert_move( std::size_t i = 0, std::size_t j = 0 ) : from( i ), to( j ) {}
+};
+
+/*
+	Function: apply_move
+
+	Applies a move to a solution. Binary solutions may be std::vector<bool>.
+*/
+
+template<class S>
+void apply_move( S & x, const bit_flip & m );
+
+template<class S>
+void apply_move( S & x, const swap_move & m );
+
+template<class S>
+void apply_move( S & x, const insert_move & m );
+
+/*
+	Function: inverse
+
+	Move which undoes a move.
+*/
+
+inline bit_flip inverse( const bit_flip & m ) { return m; }
+inline swap_move inverse( const swap_move & m ) { return m; }
+inline insert_move inverse( const insert_move & m ) { return insert_move( m.to, m.from ); }
+
+/*
+	Class: delta_model<S, T>
+
+	Base of the models without auxiliary data.
+*/
+
+template<class S, typename T = double>
+struct delta_model
+{
+	typedef S solution_type;
+	typedef T value_type;
+
+	template<class Move>
+	void apply( S & x, const Move & m ) { apply_move( x, m ); }
+};
+
+/*
+	Class: incremental_state<Model>
+
+	Solution, objective value and model of a local search.
+*/
+
+template<class Model>
+class incremental_state
+{
+public:
+	typedef Model                          model_type;
+	typedef typename Model::solution_type  solution_type;
+	typedef typename Model::value_type     value_type;
+
+	incremental_state( const Model & model, const solution_type & x ) : _model( model ), _solution( x ), _value( _model.evaluate( _solution ) ) {}
+
+	const solution_type & solution() const { return _solution; }
+	value_type value() const { return _value; }
+	const Model & model() const { return _model; }
+
+	/*
+		Method: evaluate_move
+
+		Objective value of the solution after the move, which is not applied.
+	*/
+
+	template<class Move>
+	value_type evaluate_move( const Move & m ) const
+	{
+		return _model.evaluate_move( _solution, _value, m );
+	}
+
+	/*
+		Method: apply
+
+		Applies the move. The new value may be given when the move was just
+		evaluated.
+	*/
+
+	template<class Move>
+	void apply( const Move & m )
+	{
+		apply( m, evaluate_move( m ) );
+	}
+
+	template<class Move>
+	void apply( const Move & m, value_type v )
+	{
+		_model.apply( _solution, m );
+		_value = v;
+	}
+
+	/*
+		Method: refresh
+
+		Evaluates the solution from scratch, to discard the rounding errors
+		accumulated by floating-point deltas.
+	*/
+
+	void refresh()
+	{
+		_value = _model.evaluate( _solution );
+	}
+
+private:
+	Model         _model;
+	solution_type _solution;
+	value_type    _value;
+};
+
+/*
+	Class: recompute_model<S, T>
+
+	Adaptor of any objective function, which evaluates a move on a copy of
+	the solution. Fallback for objectives without a delta formula.
+*/
+
+template<class S, typename T = double>
+class recompute_model : public delta_model<S, T>
+{
+public:
+	typedef function<T, const S &> function_type;
+
+	explicit recompute_model( function_type f ) : _function( f ) {}
+
+	T evaluate( const S & x ) const { return _function( x ); }
+
+	template<class Move>
+	T evaluate_move( const S & x, T, const Move & m ) const
+	{
+		S y( x );
+		apply_move( y, m );
+		return _function( y );
+	}
+
+private:
+	function_type _function;
+};
+
+/*
+	Class: linear_model<S, T>
+
+	Objective c + sum( w[i] x[i] ) of a binary solution, such as the value
+	or the weight of a knapsack. Bit flips are evaluated in O(1).
+*/
+
+template<class S = std::vector<bool>, typename T = double>
+class linear_model : public delta_model<S, T>
+{
+public:
+	template<class I>
+	linear_model( I first, I last, T constant = T() ) : _weights( first, last ), _constant( constant ) {}
+
+	T evaluate( const S & x ) const
+	{
+		T v = _constant;
+		for ( std::size_t i = 0; i < _weights.size(); ++i )
+		{
+			if ( x[i] ) v += _weights[i];
+		}
+		return v;
+	}
+
+	T evaluate_move( const S & x, T v, const bit_flip & m ) const
+	{
+		return x[m.index] ? v - _weights[m.index] : v + _weights[m.index];
+	}
+
+	T evaluate_move( const S & x, T v, const swap_move & m ) const
+	{
+		if ( bool( x[m.first] ) == bool( x[m.second] ) ) return v;
+		const T d = _weights[m.second] - _weights[m.first];
+		return x[m.first] ? v + d : v - d;
+	}
+
+	const std::vector<T> & weights() const { return _weights; }
+
+private:
+	std::vector<T> _weights;
+	T              _constant;
+};
+
+/*
+	Class: tour_model<S, D, T>
+
+	Length of the closed tour given by a permutation, with a distance d( a, b )
+	which need not be symmetric. Swap and insert moves are evaluated in O(1).
+*/
+
+template<class D, class S = std::vector<std::size_t>, typename T = double>
+class tour_model : public delta_model<S, T>
+{
+public:
+	explicit tour_model( D d ) : _distance( d ) {}
+
+	T evaluate( const S & x ) const
+	{
+		const std::size_t n = x.size();
+		T v = T();
+		for ( std::size_t k = 0; k < n; ++k ) v += _distance( x[k], x[( k + 1 ) % n] );
+		return v;
+	}
+
+	T evaluate_move( const S & x, T v, const swap_move & m ) const
+	{
+		const std::size_t n = x.size();
+		if ( m.first == m.second || n < 2 ) return v;
+
+		// Edges ( k, k+1 ) leaving the positions whose element changes, without duplicates.
+		std::size_t edges[4] = { ( m.first + n - 1 ) % n, m.first, ( m.second + n - 1 ) % n, m.second };
+		std::size_t * end = edges + 4;
+		std::sort( edges, end );
+		end = std::unique( edges, end );
+
+		for ( std::size_t * e = edges; e != end; ++e )
+		{
+			const std::size_t a = *e, b = ( *e + 1 ) % n;
+			v -= _distance( x[a], x[b] );
+			v += _distance( x[swapped( a, m )], x[swapped( b, m )] );
+		}
+		return v;
+	}
+
+	T evaluate_move( const S & x, T v, const insert_move & m ) const
+	{
+		const std::size_t n = x.size();
+		if ( m.from == m.to || n < 3 ) return v;
+
+		// Remove e between its neighbours p and s...
+		const std::size_t e = m.from;
+		const std::size_t p = ( e + n - 1 ) % n, s = ( e + 1 ) % n;
+		v += _distance( x[p], x[s] ) - _distance( x[p], x[e] ) - _distance( x[e], x[s] );
+
+		// ...then insert it between a and b, positions in the tour without e.
+		const std::size_t a = removed( ( m.to + n - 2 ) % ( n - 1 ), e );
+		const std::size_t b = removed( m.to % ( n - 1 ), e );
+		v += _distance( x[a], x[e] ) + _distance( x[e], x[b] ) - _distance( x[a], x[b] );
+		return v;
+	}
+
+private:
+	static std::size_t swapped( std::size_t k, const swap_move & m )
+	{
+		return ( k == m.first ) ? m.second : ( k == m.second ) ? m.first : k;
+	}
+
+	// Position in x of the k-th element once e is removed.
+	static std::size_t removed( std::size_t k, std::size_t e )
+	{
+		return ( k < e ) ? k : k + 1;
+	}
+
+	D _distance;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+template<class S>
+void apply_move( S & x, const bit_flip & m )
+{
+	x[m.index] = !x[m.index];
+}
+
+template<class S>
+void apply_move( S & x, const swap_move & m )
+{
+	// Through a copy, which also works for the proxies of std::vector<bool>.
+	const typename S::value_type t = x[m.first];
+	x[m.first]  = x[m.second];
+	x[m.second] = t;
+}
+
+template<class S>
+void apply_move( S & x, const insert_move & m )
+{
+	if ( m.from < m.to )
+	{
+		std::rotate( x.begin() + m.from, x.begin() + m.from + 1, x.begin() + m.to + 1 );
+	}
+	else if ( m.to < m.from )
+	{
+		std::rotate( x.begin() + m.to, x.begin() + m.from, x.begin() + m.from + 1 );
+	}
+}
+
+}
+
+#endif
@@ -0,0 +1,542 @@
+/*
+	Copyright (c) 2012 Charly LERSTEAU
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef OT_MEMOIZE_HPP
+#define OT_MEMOIZE_HPP
+
+#if !( __cplusplus > 201100L || __GXX_EXPERIMENTAL_CXX0X__ )
+#error "memoize.hpp requires C++11."
+#endif
+
+#include <cstddef>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stdint.h>
+#include <type_traits>
+#include <utility>
+#include <valarray>
+#include <vector>
+#include "function.hpp"
+
+namespace ot
+{
+
+/*
+	Function: xxhash64
+
+	64-bit xxHash of a block of memory.
+
+	See:
+		https://github.com/Cyan4973/xxHash
+*/
+
+inline uint64_t xxhash64( const void * data, std::size_t size, uint64_t seed = 0 );
+
+/*
+	Struct: cache_statistics
+
+	Counters of a <memoized_function>, to size its cache.
+*/
+
+struct cache_statistics
+{
+	uint64_t    hits;
+	uint64_t    misses;
+	uint64_t    evictions;
+	std::size_t entries;
+	std::size_t memory;
+
+	double hit_rate() const { return ( hits + misses > 0 ) ? double( hits ) / double( hits + misses ) : 0.0; }
+};
+
+/*
+	Class: memoized_function<R, V>
+
+	Wraps an objective function R(const V &) with a bounded cache of its
+	results, for expensive objectives re-evaluated on identical solutions.
+
+	Decision vectors are hashed with <xxhash64> over their raw bytes when
+	their elements are arithmetic and contiguous (std::vector, std::array,
+	std::valarray, std::string), element by element otherwise. A hit also
+	requires the vectors to compare equal.
+
+	The cache holds at most memory_budget bytes (entries, keys and index),
+	evicting entries with the CLOCK algorithm, an approximation of LRU that
+	only sets a bit on hits. It may be split into shards, each with its own
+	lock, for concurrent use; the function itself is evaluated outside of
+	any lock.
+*/
+
+template<typename R, typename V>
+class memoized_function
+{
+public:
+	typedef R result_type;
+	typedef V argument_type;
+	typedef function<R(const V &)> function_type;
+
+	explicit memoized_function( function_type f, std::size_t memory_budget = 64 << 20, std::size_t shards = 1 );
+
+	R operator () ( const V & x ) const;
+
+	cache_statistics statistics() const;
+	void clear();
+
+private:
+	struct entry
+	{
+		V           key;
+		R           value;
+		uint64_t    hash;
+		std::size_t memory;
+		bool        referenced;
+		bool        occupied;
+	};
+
+	struct shard
+	{
+		std::mutex            mutex;
+		std::vector<entry>    entries;
+		std::vector<uint32_t> free;   // Unoccupied entries.
+		std::vector<uint32_t> index;  // Open-addressing table of entry + 1, 0 if empty.
+		std::size_t           hand;   // CLOCK hand.
+		std::size_t           size;
+		std::size_t           memory; // Of the keys, the containers excluded.
+		uint64_t              hits;
+		uint64_t              misses;
+		uint64_t              evictions;
+
+		shard() : hand( 0 ), size( 0 ), memory( 0 ), hits( 0 ), misses( 0 ), evictions( 0 ) {}
+
+		const entry * find( uint64_t hash, const V & key );
+		void insert( uint64_t hash, const V & key, const R & value, std::size_t budget );
+		void erase( uint32_t e );
+		void evict();
+		void grow();
+		void clear();
+
+		// Bytes held by the containers, which never shrink until clear().
+		std::size_t overhead() const
+		{
+			return entries.capacity() * sizeof( entry ) + ( free.capacity() + index.capacity() ) * sizeof( uint32_t );
+		}
+	};
+
+	function_type                  _function;
+	std::size_t                    _budget; // Per shard.
+	unsigned                       _shift;  // Shard of a hash: hash >> _shift.
+	std::unique_ptr<shard[]>       _shards;
+	std::size_t                    _count;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace detail
+{
+
+inline uint64_t xxhash64_rotl( uint64_t x, int r )
+{
+	return ( x << r ) | ( x >> ( 64 - r ) );
+}
+
+inline uint64_t xxhash64_read64( const unsigned char * p )
+{
+	uint64_t x;
+	std::memcpy( &x, p, sizeof( x ) );
+	return x;
+}
+
+inline uint32_t xxhash64_read32( const unsigned char * p )
+{
+	uint32_t x;
+	std::memcpy( &x, p, sizeof( x ) );
+	return x;
+}
+
+const uint64_t xxhash64_prime1 = UINT64_C(11400714785074694791);
+const uint64_t xxhash64_prime2 = UINT64_C(14029467366897019727);
+const uint64_t xxhash64_prime3 = UINT64_C(1609587929392839161);
+const uint64_t xxhash64_prime4 = UINT64_C(9650029242287828579);
+const uint64_t xxhash64_prime5 = UINT64_C(2870177450012600261);
+
+inline uint64_t xxhash64_round( uint64_t acc, uint64_t input )
+{
+	acc += input * xxhash64_prime2;
+	acc  = xxhash64_rotl( acc, 31 );
+	return acc * xxhash64_prime1;
+}
+
+inline uint64_t xxhash64_merge( uint64_t acc, uint64_t v )
+{
+	acc ^= xxhash64_round( 0, v );
+	return acc * xxhash64_prime1 + xxhash64_prime4;
+}
+
+// Hash of a decision vector: raw bytes of contiguous arithmetic elements.
+template<class V>
+auto memo_hash( const V & x, int ) -> typename std::enable_if<
+	std::is_arithmetic<typename std::remove_reference<decltype( *x.data() )>::type>::value, uint64_t>::type
+{
+	return xxhash64( x.data(), x.size() * sizeof( *x.data() ) );
+}
+
+template<typename T>
+inline uint64_t memo_hash( const std::valarray<T> & x, int )
+{
+	return x.size() > 0 ? xxhash64( &x[0], x.size() * sizeof( T ) ) : xxhash64( 0, 0 );
+}
+
+// Otherwise, element by element.
+template<class V>
+uint64_t memo_hash( const V & x, long )
+{
+	uint64_t h = xxhash64_prime5;
+	for ( const auto & e : x )
+	{
+		h = xxhash64_merge( h, std::hash<typename std::decay<decltype( e )>::type>()( e ) );
+	}
+	return xxhash64_round( h, 0 );
+}
+
+// Equality of decision vectors; valarray compares element-wise.
+template<class V>
+bool memo_equal( const V & x, const V & y )
+{
+	return x == y;
+}
+
+template<typename T>
+bool memo_equal( const std::valarray<T> & x, const std::valarray<T> & y )
+{
+	if ( x.size() != y.size() ) return false;
+	for ( std::size_t i = 0; i < x.size(); ++i )
+	{
+		if ( !( x[i] == y[i] ) ) return false;
+	}
+	return true;
+}
+
+// Dynamic memory held by a decision vector.
+template<class V>
+auto memo_dynamic_memory( const V & x, int ) -> decltype( x.size() * sizeof( typename V::value_type ) )
+{
+	return x.size() * sizeof( typename V::value_type );
+}
+
+template<class V>
+std::size_t memo_dynamic_memory( const V &, long )
+{
+	return 0;
+}
+
+}
+
+inline uint64_t xxhash64( const void * data, std::size_t size, uint64_t seed )
+{
+	using namespace detail;
+
+	const unsigned char * p   = static_cast<const unsigned char *>( data );
+	const unsigned char * end = p + size;
+	uint64_t h;
+
+	if ( size >= 32 )
+	{
+		uint64_t v1 = seed + xxhash64_prime1 + xxhash64_prime2;
+		uint64_t v2 = seed + xxhash64_prime2;
+		uint64_t v3 = seed;
+		uint64_t v4 = seed - xxhash64_prime1;
+
+		for ( ; p + 32 <= end; p += 32 )
+		{
+			v1 = xxhash64_round( v1, xxhash64_read64( p ) );
+			v2 = xxhash64_round( v2, xxhash64_read64( p + 8 ) );
+			v3 = xxhash64_round( v3, xxhash64_read64( p + 16 ) );
+			v4 = xxhash64_round( v4, xxhash64_read64( p + 24 ) );
+		}
+
+		h = xxhash64_rotl( v1, 1 ) + xxhash64_rotl( v2, 7 ) + xxhash64_rotl( v3, 12 ) + xxhash64_rotl( v4, 18 );
+		h = xxhash64_merge( h, v1 );
+		h = xxhash64_merge( h, v2 );
+		h = xxhash64_merge( h, v3 );
+		h = xxhash64_merge( h, v4 );
+	}
+	else
+	{
+		h = seed + xxhash64_prime5;
+	}
+
+	h += uint64_t( size );
+
+	for ( ; p + 8 <= end; p += 8 )
+	{
+		h ^= xxhash64_round( 0, xxhash64_read64( p ) );
+		h  = xxhash64_rotl( h, 27 ) * xxhash64_prime1 + xxhash64_prime4;
+	}
+	if ( p + 4 <= end )
+	{
+		h ^= uint64_t( xxhash64_read32( p ) ) * xxhash64_prime1;
+		h  = xxhash64_rotl( h, 23 ) * xxhash64_prime2 + xxhash64_prime3;
+		p += 4;
+	}
+	for ( ; p < end; ++p )
+	{
+		h ^= uint64_t( *p ) * xxhash64_prime5;
+		h  = xxhash64_rotl( h, 11 ) * xxhash64_prime1;
+	}
+
+	h ^= h >> 33;
+	h *= xxhash64_prime2;
+	h ^= h >> 29;
+	h *= xxhash64_prime3;
+	h ^= h >> 32;
+	return h;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+template<typename R, typename V>
+memoized_function<R,V>::memoized_function( function_type f, std::size_t memory_budget, std::size_t shards ) : _function( std::move( f ) ), _shift( 64 ), _count( 1 )
+{
+	// Round the number of shards up to a power of two.
+	while ( _count < shards )
+	{
+		_count <<= 1;
+		--_shift;
+	}
+	_budget = memory_budget / _count;
+	_shards.reset( new shard[_count] );
+}
+
+template<typename R, typename V>
+R memoized_function<R,V>::operator () ( const V & x ) const
+{
+	const uint64_t hash = detail::memo_hash( x, 0 );
+	shard & s = _shards[( _shift < 64 ) ? std::size_t( hash >> _shift ) : 0];
+
+	{
+		std::lock_guard<std::mutex> lock( s.mutex );
+		if ( const entry * e = s.find( hash, x ) ) return e->value;
+		++s.misses;
+	}
+
+	// Evaluate without holding the lock.
+	const R value = _function( x );
+
+	std::lock_guard<std::mutex> lock( s.mutex );
+	s.insert( hash, x, value, _budget );
+	return value;
+}
+
+template<typename R, typename V>
+cache_statistics memoized_function<R,V>::statistics() const
+{
+	cache_statistics c = { 0, 0, 0, 0, 0 };
+	for ( std::size_t i = 0; i < _count; ++i )
+	{
+		shard & s = _shards[i];
+		std::lock_guard<std::mutex> lock( s.mutex );
+		c.hits      += s.hits;
+		c.misses    += s.misses;
+		c.evictions += s.evictions;
+		c.entries   += s.size;
+		c.memory    += s.memory + s.overhead();
+	}
+	return c;
+}
+
+template<typename R, typename V>
+void memoized_function<R,V>::clear()
+{
+	for ( std::size_t i = 0; i < _count; ++i )
+	{
+		std::lock_guard<std::mutex> lock( _shards[i].mutex );
+		_shards[i].clear();
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+template<typename R, typename V>
+const typename memoized_function<R,V>::entry * memoized_function<R,V>::shard::find( uint64_t hash, const V & key )
+{
+	if ( index.empty() ) return 0;
+
+	const std::size_t mask = index.size() - 1;
+	for ( std::size_t i = std::size_t( hash ) & mask; index[i] != 0; i = ( i + 1 ) & mask )
+	{
+		entry & e = entries[index[i] - 1];
+		if ( e.hash == hash && detail::memo_equal( e.key, key ) )
+		{
+			e.referenced = true;
+			++hits;
+			return &e;
+		}
+	}
+	return 0;
+}
+
+template<typename R, typename V>
+void memoized_function<R,V>::shard::insert( uint64_t hash, const V & key, const R & value, std::size_t budget )
+{
+	// Another thread may have inserted the same key meanwhile.
+	if ( !index.empty() )
+	{
+		const std::size_t mask = index.size() - 1;
+		for ( std::size_t i = std::size_t( hash ) & mask; index[i] != 0; i = ( i + 1 ) & mask )
+		{
+			const entry & e = entries[index[i] - 1];
+			if ( e.hash == hash && detail::memo_equal( e.key, key ) ) return;
+		}
+	}
+
+	// Evicts until the key and the containers after the insertion fit in
+	// the budget. Evictions free slots, so that the containers stop growing.
+	const std::size_t m = detail::memo_dynamic_memory( key, 0 );
+	const std::size_t capacity = entries.capacity() == 0 ? 16 : 2 * entries.capacity();
+	for ( ;; )
+	{
+		std::size_t need = memory + m + overhead();
+		if ( free.empty() && entries.size() == entries.capacity() )
+		{
+			need += ( capacity - entries.capacity() ) * ( sizeof( entry ) + sizeof( uint32_t ) );
+		}
+		if ( 2 * ( size + 1 ) > index.size() )
+		{
+			need += ( index.empty() ? 16 : index.size() ) * sizeof( uint32_t );
+		}
+		if ( need <= budget ) break;
+		if ( size == 0 ) return;
+		evict();
+	}
+
+	uint32_t slot;
+	if ( !free.empty() )
+	{
+		slot = free.back();
+		free.pop_back();
+	}
+	else
+	{
+		// Grown explicitly, so that the capacities charged above are exact;
+		// the free list can then hold every slot without growing.
+		if ( entries.size() == entries.capacity() )
+		{
+			entries.reserve( capacity );
+			free.reserve( capacity );
+		}
+		slot = uint32_t( entries.size() );
+		entries.push_back( entry() );
+	}
+
+	entry & e = entries[slot];
+	e.key        = key;
+	e.value      = value;
+	e.hash       = hash;
+	e.memory     = m;
+	e.referenced = false;
+	e.occupied   = true;
+	memory += m;
+	++size;
+
+	if ( 2 * size > index.size() ) grow();
+
+	const std::size_t mask = index.size() - 1;
+	std::size_t i = std::size_t( hash ) & mask;
+	while ( index[i] != 0 ) i = ( i + 1 ) & mask;
+	index[i] = slot + 1;
+}
+
+template<typename R, typename V>
+void memoized_function<R,V>::shard::evict()
+{
+	// Second chance: referenced entries lose their bit and are skipped once.
+	for ( ;; hand = ( hand + 1 ) % entries.size() )
+	{
+		entry & e = entries[hand];
+		if ( !e.occupied ) continue;
+		if ( e.referenced )
+		{
+			e.referenced = false;
+			continue;
+		}
+		erase( uint32_t( hand ) );
+		++evictions;
+		hand = ( hand + 1 ) % entries.size();
+		return;
+	}
+}
+
+template<typename R, typename V>
+void memoized_function<R,V>::shard::erase( uint32_t slot )
+{
+	entry & e = entries[slot];
+	const std::size_t mask = index.size() - 1;
+
+	std::size_t i = std::size_t( e.hash ) & mask;
+	while ( index[i] != slot + 1 ) i = ( i + 1 ) & mask;
+
+	// Backward shift deletion, which keeps probe sequences without tombstones.
+	for ( std::size_t j = ( i + 1 ) & mask; index[j] != 0; j = ( j + 1 ) & mask )
+	{
+		const std::size_t home = std::size_t( entries[index[j] - 1].hash ) & mask;
+		if ( ( ( j - home ) & mask ) >= ( ( j - i ) & mask ) )
+		{
+			index[i] = index[j];
+			i = j;
+		}
+	}
+	index[i] = 0;
+
+	memory -= e.memory;
+	--size;
+	e.key      = V();
+	e.occupied = false;
+	free.push_back( slot );
+}
+
+template<typename R, typename V>
+void memoized_function<R,V>::shard::grow()
+{
+	std::vector<uint32_t> table( index.empty() ? 16 : 2 * index.size(), 0 );
+	const std::size_t mask = table.size() - 1;
+
+	for ( std::size_t k = 0; k < entries.size(); ++k )
+	{
+		if ( !entries[k].occupied ) continue;
+		std::size_t i = std::size_t( entries[k].hash ) & mask;
+		while ( table[i] != 0 ) i = ( i + 1 ) & mask;
+		table[i] = uint32_t( k + 1 );
+	}
+	index.swap( table );
+}
+
+template<typename R, typename V>
+void memoized_function<R,V>::shard::clear()
+{
+	entries.clear();
+	free.clear();
+	index.clear();
+	hand   = 0;
+	size   = 0;
+	memory = 0;
+}
+
+}
+
+#endif
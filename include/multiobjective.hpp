@@ -0,0 +1,277 @@
+/*
+	Copyright (c) 2012 Charly LERSTEAU
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef OT_MULTIOBJECTIVE_HPP
+#define OT_MULTIOBJECTIVE_HPP
+
+#if !( __cplusplus > 201100L || __GXX_EXPERIMENTAL_CXX0X__ )
+#error "multiobjective.hpp requires C++11."
+#endif
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <utility>
+#include <vector>
+#include "algorithm.hpp"
+#include "function.hpp"
+#include "span.hpp"
+#include "thread_pool.hpp"
+
+namespace ot
+{
+
+/*
+	Class: vector_function<X, T>
+
+	Multi-objective function of a solution X, which writes its m objectives
+	and c constraint violations into buffers given by the caller instead of
+	returning a container, so that evaluations do not allocate.
+
+	The wrapped function has the signature
+	void( const X & x, span<T> objectives, span<T> violations ), where a
+	violation is positive when the constraint is violated and zero (or
+	negative) otherwise. Unconstrained functions ignore the last span.
+*/
+
+template<class X, typename T = double>
+class vector_function
+{
+public:
+	typedef X solution_type;
+	typedef T value_type;
+	typedef function<void(const X &, span<T>, span<T>)> function_type;
+
+	vector_function( function_type f, std::size_t objectives, std::size_t constraints = 0 ) : _function( std::move( f ) ), _objectives( objectives ), _constraints( constraints ) {}
+
+	void operator () ( const X & x, span<T> objectives, span<T> violations = span<T>() ) const
+	{
+		assert( objectives.size() == _objectives && violations.size() == _constraints );
+		_function( x, objectives, violations );
+	}
+
+	void operator () ( const X & x, T * objectives, T * violations = 0 ) const
+	{
+		_function( x, span<T>( objectives, _objectives ), span<T>( violations, violations ? _constraints : 0 ) );
+	}
+
+	std::size_t objectives() const { return _objectives; }
+	std::size_t constraints() const { return _constraints; }
+
+private:
+	function_type _function;
+	std::size_t   _objectives;
+	std::size_t   _constraints;
+};
+
+/*
+	Class: population<X, T>
+
+	Solutions with their objectives and constraint violations, each stored
+	in one contiguous row-major array, so that rows are passed as spans to
+	a <vector_function> and to the dominance functions of algorithm.hpp.
+*/
+
+template<class X, typename T = double>
+class population
+{
+public:
+	typedef X solution_type;
+	typedef T value_type;
+
+	explicit population( std::size_t objectives, std::size_t constraints = 0 ) : _objective_count( objectives ), _constraint_count( constraints ) {}
+
+	std::size_t size() const { return _solutions.size(); }
+	bool empty() const { return _solutions.empty(); }
+	std::size_t objective_count() const { return _objective_count; }
+	std::size_t constraint_count() const { return _constraint_count; }
+
+	void reserve( std::size_t n );
+	void resize( std::size_t n );
+	void clear();
+
+	void push_back( const X & x );
+	void pop_back();
+	void swap( std::size_t i, std::size_t j );
+	void erase( std::size_t i );
+
+	X & solution( std::size_t i ) { return _solutions[i]; }
+	const X & solution( std::size_t i ) const { return _solutions[i]; }
+
+	span<T> objectives( std::size_t i ) { return span<T>( _objectives.data() + i * _objective_count, _objective_count ); }
+	span<const T> objectives( std::size_t i ) const { return span<const T>( _objectives.data() + i * _objective_count, _objective_count ); }
+
+	span<T> violations( std::size_t i ) { return span<T>( _violations.data() + i * _constraint_count, _constraint_count ); }
+	span<const T> violations( std::size_t i ) const { return span<const T>( _violations.data() + i * _constraint_count, _constraint_count ); }
+
+	T * objective_data() { return _objectives.data(); }
+	const T * objective_data() const { return _objectives.data(); }
+
+	T total_violation( std::size_t i ) const;
+	bool feasible( std::size_t i ) const { return !( T() < total_violation( i ) ); }
+
+	bool dominates( std::size_t i, std::size_t j ) const;
+
+private:
+	std::size_t    _objective_count;
+	std::size_t    _constraint_count;
+	std::vector<X> _solutions;
+	std::vector<T> _objectives;
+	std::vector<T> _violations;
+};
+
+/*
+	Function: evaluate
+
+	Evaluates every solution of a population with f, writing in place; the
+	population must have as many objectives and constraints as f. With a
+	thread pool, solutions are evaluated in parallel.
+*/
+
+template<class X, typename T>
+void evaluate( const vector_function<X, T> & f, population<X, T> & p );
+
+template<class X, typename T>
+void evaluate( thread_pool & pool, const vector_function<X, T> & f, population<X, T> & p, std::size_t chunk = 0 );
+
+////////////////////////////////////////////////////////////////////////////////
+
+template<class X, typename T>
+void population<X, T>::reserve( std::size_t n )
+{
+	_solutions.reserve( n );
+	_objectives.reserve( n * _objective_count );
+	_violations.reserve( n * _constraint_count );
+}
+
+template<class X, typename T>
+void population<X, T>::resize( std::size_t n )
+{
+	_solutions.resize( n );
+	_objectives.resize( n * _objective_count );
+	_violations.resize( n * _constraint_count );
+}
+
+template<class X, typename T>
+void population<X, T>::clear()
+{
+	_solutions.clear();
+	_objectives.clear();
+	_violations.clear();
+}
+
+template<class X, typename T>
+void population<X, T>::push_back( const X & x )
+{
+	_solutions.push_back( x );
+	_objectives.resize( _objectives.size() + _objective_count );
+	_violations.resize( _violations.size() + _constraint_count );
+}
+
+template<class X, typename T>
+void population<X, T>::pop_back()
+{
+	_solutions.pop_back();
+	_objectives.resize( _objectives.size() - _objective_count );
+	_violations.resize( _violations.size() - _constraint_count );
+}
+
+template<class X, typename T>
+void population<X, T>::swap( std::size_t i, std::size_t j )
+{
+	using std::swap;
+	swap( _solutions[i], _solutions[j] );
+	std::swap_ranges( objectives( i ).begin(), objectives( i ).end(), objectives( j ).begin() );
+	std::swap_ranges( violations( i ).begin(), violations( i ).end(), violations( j ).begin() );
+}
+
+/*
+	Method: erase
+
+	Removes the i-th solution in O(1), by moving the last one in its place.
+*/
+
+template<class X, typename T>
+void population<X, T>::erase( std::size_t i )
+{
+	if ( i + 1 != size() ) swap( i, size() - 1 );
+	pop_back();
+}
+
+template<class X, typename T>
+T population<X, T>::total_violation( std::size_t i ) const
+{
+	T v = T();
+	const span<const T> g = violations( i );
+	for ( std::size_t k = 0; k < g.size(); ++k )
+	{
+		if ( T() < g[k] ) v += g[k];
+	}
+	return v;
+}
+
+/*
+	Method: dominates
+
+	Constrained dominance (Deb): a feasible solution dominates an infeasible
+	one, of two infeasible solutions the least violating dominates, and
+	feasible solutions compare their objectives with <ot::dominates>.
+*/
+
+template<class X, typename T>
+bool population<X, T>::dominates( std::size_t i, std::size_t j ) const
+{
+	if ( _constraint_count > 0 )
+	{
+		const T vi = total_violation( i ), vj = total_violation( j );
+		if ( T() < vi || T() < vj ) return vi < vj;
+	}
+
+	const span<const T> a = objectives( i ), b = objectives( j );
+	return ot::dominates( a.begin(), a.end(), b.begin(), b.end() );
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+template<class X, typename T>
+void evaluate( const vector_function<X, T> & f, population<X, T> & p )
+{
+	assert( f.objectives() == p.objective_count() && f.constraints() == p.constraint_count() );
+
+	for ( std::size_t i = 0; i < p.size(); ++i )
+	{
+		f( p.solution( i ), p.objectives( i ), p.violations( i ) );
+	}
+}
+
+template<class X, typename T>
+void evaluate( thread_pool & pool, const vector_function<X, T> & f, population<X, T> & p, std::size_t chunk )
+{
+	assert( f.objectives() == p.objective_count() && f.constraints() == p.constraint_count() );
+
+	pool.parallel_for( std::size_t( 0 ), p.size(), [&f, &p] ( std::size_t first, std::size_t last )
+	{
+		for ( std::size_t i = first; i < last; ++i )
+		{
+			f( p.solution( i ), p.objectives( i ), p.violations( i ) );
+		}
+	}, chunk );
+}
+
+}
+
+#endif
@@ -0,0 +1,260 @@
+/*
+	Copyright (c) 2012 Charly LERSTEAU
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef OT_MULTISTART_HPP
+#define OT_MULTISTART_HPP
+
+#if !( __cplusplus > 201100L || __GXX_EXPERIMENTAL_CXX0X__ )
+#error "multistart.hpp requires C++11."
+#endif
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <limits>
+#include <mutex>
+#include <stdint.h>
+#include <vector>
+#include "function.hpp"
+#include "random.hpp"
+#include "thread_pool.hpp"
+
+namespace ot
+{
+
+/*
+	Class: multistart<X, T, E>
+
+	Runs independent restarts of a local search, minimizing, in parallel
+	on a thread pool or sequentially.
+
+	Each restart is a function called with a <context>, which gives it:
+		- its own random engine, seeded from the master seed and the index
+		  of the restart as engine_pool does, so that a restart draws the
+		  same numbers whichever thread runs it,
+		- the incumbent, the best value found by all restarts so far, held
+		  in a lock-free atomic, against which a restart may prune itself,
+		- submit(), to report a solution.
+
+	The search stops when the incumbent reaches a target value or after a
+	time limit; the remaining restarts are then skipped and the running
+	ones see stopped(). Every improvement of the incumbent is recorded with
+	its time, which gives the time-to-target profile of the run.
+*/
+
+template<class X, typename T = double, class E = mt19937>
+class multistart
+{
+public:
+	typedef X solution_type;
+	typedef T value_type;
+	typedef E engine_type;
+
+	class context
+	{
+	public:
+		E & engine() { return _engine; }
+		std::size_t restart() const { return _index; }
+
+		T incumbent() const { return _owner._incumbent.load( std::memory_order_relaxed ); }
+		bool prune( T lower_bound ) const { return !( lower_bound < incumbent() ); }
+		bool stopped() const { return _owner.stopped(); }
+		double seconds() const { return _owner.seconds(); }
+
+		bool submit( const X & x, T value ) { return _owner.submit( x, value, _index ); }
+
+	private:
+		friend class multistart;
+
+		context( multistart & owner, std::size_t index, const seed_seq & seeds );
+
+		multistart & _owner;
+		std::size_t  _index;
+		E            _engine;
+	};
+
+	typedef function<void(context &)> restart_type;
+
+	struct improvement
+	{
+		double      seconds;
+		T           value;
+		std::size_t restart;
+	};
+
+	explicit multistart( restart_type f, uint64_t seed = 0 );
+
+	void set_target( T target ) { _target = target; _has_target = true; }
+	void set_time_limit( double seconds ) { _time_limit = seconds; }
+
+	void run( std::size_t restarts );
+	void run( thread_pool & pool, std::size_t restarts );
+
+	bool found() const { return _found; }
+	const X & best() const { return _best; }
+	T best_value() const { return _best_value; }
+	std::size_t completed() const { return _completed; }
+
+	const std::vector<improvement> & profile() const { return _profile; }
+	double time_to_target( T target ) const;
+
+private:
+	multistart( const multistart & );
+	multistart & operator = ( const multistart & );
+
+	typedef std::chrono::steady_clock clock_type;
+
+	static T worst() { return std::numeric_limits<T>::has_infinity ? std::numeric_limits<T>::infinity() : std::numeric_limits<T>::max(); }
+
+	void reset();
+	void run_restart( std::size_t i );
+	bool submit( const X & x, T value, std::size_t restart );
+	bool stopped() const;
+	double seconds() const { return std::chrono::duration<double>( clock_type::now() - _start ).count(); }
+
+	restart_type             _function;
+	uint64_t                 _seed;
+	T                        _target;
+	bool                     _has_target;
+	double                   _time_limit;
+
+	clock_type::time_point   _start;
+	std::atomic<T>           _incumbent;
+	std::atomic<bool>        _stop;
+	std::atomic<std::size_t> _completed;
+
+	std::mutex               _mutex; // Guards the members below.
+	bool                     _found;
+	X                        _best;
+	T                        _best_value;
+	std::vector<improvement> _profile;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+template<class X, typename T, class E>
+multistart<X, T, E>::context::context( multistart & owner, std::size_t index, const seed_seq & seeds ) : _owner( owner ), _index( index )
+{
+	seed_seq q( seeds );
+	_engine.seed( q );
+}
+
+template<class X, typename T, class E>
+multistart<X, T, E>::multistart( restart_type f, uint64_t seed ) : _function( std::move( f ) ), _seed( seed ), _target( T() ), _has_target( false ), _time_limit( 0.0 ), _incumbent( worst() ), _stop( false ), _completed( 0 ), _found( false ), _best(), _best_value( worst() )
+{
+}
+
+template<class X, typename T, class E>
+void multistart<X, T, E>::reset()
+{
+	_start      = clock_type::now();
+	_incumbent  = worst();
+	_stop       = false;
+	_completed  = 0;
+	_found      = false;
+	_best       = X();
+	_best_value = worst();
+	_profile.clear();
+}
+
+template<class X, typename T, class E>
+void multistart<X, T, E>::run( std::size_t restarts )
+{
+	reset();
+	for ( std::size_t i = 0; i < restarts; ++i ) run_restart( i );
+}
+
+template<class X, typename T, class E>
+void multistart<X, T, E>::run( thread_pool & pool, std::size_t restarts )
+{
+	reset();
+	pool.parallel_for( std::size_t( 0 ), restarts, [this] ( std::size_t first, std::size_t last )
+	{
+		for ( std::size_t i = first; i < last; ++i ) run_restart( i );
+	}, 1 );
+}
+
+template<class X, typename T, class E>
+void multistart<X, T, E>::run_restart( std::size_t i )
+{
+	if ( stopped() ) return;
+
+	// Same seeds as engine i of an engine_pool with this master seed.
+	const uint32_t words[4] =
+	{
+		uint32_t( _seed ), uint32_t( _seed >> 32 ),
+		uint32_t( i ), uint32_t( uint64_t( i ) >> 16 >> 16 )
+	};
+	context c( *this, i, seed_seq( words, words + 4 ) );
+	_function( c );
+	++_completed;
+}
+
+template<class X, typename T, class E>
+bool multistart<X, T, E>::submit( const X & x, T value, std::size_t restart )
+{
+	// Lock-free fast path: most solutions do not beat the incumbent.
+	T current = _incumbent.load( std::memory_order_relaxed );
+	do
+	{
+		if ( !( value < current ) ) return false;
+	}
+	while ( !_incumbent.compare_exchange_weak( current, value, std::memory_order_relaxed ) );
+
+	// Improvements arriving out of order are filtered again under the lock.
+	std::lock_guard<std::mutex> lock( _mutex );
+	if ( value < _best_value )
+	{
+		_found      = true;
+		_best       = x;
+		_best_value = value;
+
+		const improvement p = { seconds(), value, restart };
+		_profile.push_back( p );
+
+		if ( _has_target && !( _target < value ) ) _stop = true;
+	}
+	return true;
+}
+
+template<class X, typename T, class E>
+bool multistart<X, T, E>::stopped() const
+{
+	if ( _stop.load( std::memory_order_relaxed ) ) return true;
+	return _time_limit > 0.0 && seconds() > _time_limit;
+}
+
+/*
+	Method: time_to_target
+
+	Seconds after which the incumbent reached the target, or a negative
+	value if it never did.
+*/
+
+template<class X, typename T, class E>
+double multistart<X, T, E>::time_to_target( T target ) const
+{
+	for ( std::size_t k = 0; k < _profile.size(); ++k )
+	{
+		if ( !( target < _profile[k].value ) ) return _profile[k].seconds;
+	}
+	return -1.0;
+}
+
+}
+
+#endif
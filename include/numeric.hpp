@@ -0,0 +1,322 @@
+/*
+	Copyright (c) 2012 Charly LERSTEAU
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef OT_NUMERIC_HPP
+#define OT_NUMERIC_HPP
+
+#include <cstddef>
+#include <iterator>
+#include <vector>
+#include "functional.hpp"
+
+#if __cplusplus > 201100L || __GXX_EXPERIMENTAL_CXX0X__
+#include "thread_pool.hpp"
+#endif
+
+/*
+	Macro: OT_REDUCE_BLOCK_SIZE
+
+	Number of elements reduced by a task of <transform_reduce>.
+*/
+
+#ifndef OT_REDUCE_BLOCK_SIZE
+#define OT_REDUCE_BLOCK_SIZE 4096
+#endif
+
+namespace ot
+{
+
+/*
+	Class: reduction_traits<F>
+
+	Whether a binary functor F is associative, and its identity element.
+	Specialized for the associative functors of functional.hpp; may be
+	specialized for other functors.
+*/
+
+template<class F>
+struct reduction_traits
+{
+	static const bool associative = false;
+};
+
+template<typename T>
+struct reduction_traits< plus<T, T> >
+{
+	static const bool associative = true;
+	static T identity() { return T(); }
+};
+
+template<typename T>
+struct reduction_traits< multiplies<T, T> >
+{
+	static const bool associative = true;
+	static T identity() { return T( 1 ); }
+};
+
+template<typename T>
+struct reduction_traits< logical_and<T, T> >
+{
+	static const bool associative = true;
+	static bool identity() { return true; }
+};
+
+template<typename T>
+struct reduction_traits< logical_or<T, T> >
+{
+	static const bool associative = true;
+	static bool identity() { return false; }
+};
+
+/*
+	Function: transform_reduce
+
+	(C++17) Reduces the transformed elements of one or two ranges with init:
+	- transform_reduce( first1, last1, first2, init ) is the inner product
+	  with ot::plus and ot::multiplies, the products being computed in the
+	  value types of the ranges rather than in the type of init,
+	- transform_reduce( first1, last1, first2, init, reduce, transform ),
+	- transform_reduce( first, last, init, reduce, transform ).
+
+	When the reduction is associative (see <reduction_traits>) and the
+	iterators are random access, the range is cut into blocks of
+	OT_REDUCE_BLOCK_SIZE elements, each reduced with eight interleaved
+	accumulators so that the loop vectorizes, and the blocks are combined
+	pairwise. The order of the operations only depends on the size of the
+	range: the result is the same, to the bit, with or without a thread
+	pool and whatever its size, and pairwise summation keeps the rounding
+	error in O(log n). Other reductions are folded from left to right.
+
+	With a thread pool (C++11), the blocks are reduced in parallel.
+*/
+
+template<typename I1, typename I2, typename T>
+T transform_reduce( I1 first1, I1 last1, I2 first2, T init );
+
+template<typename I1, typename I2, typename T, class R, class F>
+T transform_reduce( I1 first1, I1 last1, I2 first2, T init, R reduce, F transform );
+
+template<typename I, typename T, class R, class F>
+T transform_reduce( I first, I last, T init, R reduce, F transform );
+
+#if __cplusplus > 201100L || __GXX_EXPERIMENTAL_CXX0X__
+
+template<typename I1, typename I2, typename T>
+T transform_reduce( thread_pool & pool, I1 first1, I1 last1, I2 first2, T init );
+
+template<typename I1, typename I2, typename T, class R, class F>
+T transform_reduce( thread_pool & pool, I1 first1, I1 last1, I2 first2, T init, R reduce, F transform );
+
+template<typename I, typename T, class R, class F>
+T transform_reduce( thread_pool & pool, I first, I last, T init, R reduce, F transform );
+
+#endif
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace detail
+{
+
+// Transformed k-th element of one range.
+template<typename I, class F, typename T>
+struct unary_access
+{
+	I first;
+	F transform;
+
+	T operator () ( std::size_t k ) const { return T( transform( first[k] ) ); }
+};
+
+// Transformed k-th elements of two ranges.
+template<typename I1, typename I2, class F, typename T>
+struct binary_access
+{
+	I1 first1;
+	I2 first2;
+	F  transform;
+
+	T operator () ( std::size_t k ) const { return T( transform( first1[k], first2[k] ) ); }
+};
+
+// Reduction of the elements [first, last) with eight interleaved accumulators.
+template<typename T, class R, class A>
+T reduce_block( const A & at, std::size_t first, std::size_t last, R reduce )
+{
+	const T e = reduction_traits<R>::identity();
+	T acc[8] = { e, e, e, e, e, e, e, e };
+
+	std::size_t k = first;
+	for ( ; k + 8 <= last; k += 8 )
+	{
+		for ( unsigned l = 0; l < 8; ++l ) acc[l] = reduce( acc[l], at( k + l ) );
+	}
+	for ( unsigned l = 0; k < last; ++k, ++l ) acc[l] = reduce( acc[l], at( k ) );
+
+	for ( unsigned l = 0; l < 4; ++l ) acc[l] = reduce( acc[l], acc[l + 4] );
+	for ( unsigned l = 0; l < 2; ++l ) acc[l] = reduce( acc[l], acc[l + 2] );
+	return reduce( acc[0], acc[1] );
+}
+
+// Pairwise reduction of the blocks [first, last) of n elements.
+template<typename T, class R, class A>
+T reduce_blocks( const A & at, std::size_t n, std::size_t first, std::size_t last, R reduce )
+{
+	if ( last - first == 1 )
+	{
+		const std::size_t b = first * OT_REDUCE_BLOCK_SIZE;
+		const std::size_t e = ( b + OT_REDUCE_BLOCK_SIZE < n ) ? b + OT_REDUCE_BLOCK_SIZE : n;
+		return reduce_block<T>( at, b, e, reduce );
+	}
+	const std::size_t middle = first + ( last - first ) / 2;
+	return reduce( reduce_blocks<T>( at, n, first, middle, reduce ), reduce_blocks<T>( at, n, middle, last, reduce ) );
+}
+
+// Same tree as reduce_blocks, on the results of the blocks.
+template<typename T, class R>
+T reduce_partials( const std::vector<T> & p, std::size_t first, std::size_t last, R reduce )
+{
+	if ( last - first == 1 ) return p[first];
+	const std::size_t middle = first + ( last - first ) / 2;
+	return reduce( reduce_partials( p, first, middle, reduce ), reduce_partials( p, middle, last, reduce ) );
+}
+
+template<typename T, class R, class A>
+T reduce_access( const A & at, std::size_t n, T init, R reduce )
+{
+	if ( n == 0 ) return init;
+	const std::size_t blocks = ( n + OT_REDUCE_BLOCK_SIZE - 1 ) / OT_REDUCE_BLOCK_SIZE;
+	return reduce( init, reduce_blocks<T>( at, n, 0, blocks, reduce ) );
+}
+
+template<bool Blocked>
+struct transform_reduce_impl
+{
+	template<typename I1, typename I2, typename T, class R, class F>
+	static T binary( I1 first1, I1 last1, I2 first2, T init, R reduce, F transform )
+	{
+		for ( ; first1 != last1; ++first1, ++first2 ) init = reduce( init, transform( *first1, *first2 ) );
+		return init;
+	}
+
+	template<typename I, typename T, class R, class F>
+	static T unary( I first, I last, T init, R reduce, F transform )
+	{
+		for ( ; first != last; ++first ) init = reduce( init, transform( *first ) );
+		return init;
+	}
+};
+
+template<>
+struct transform_reduce_impl<true>
+{
+	template<typename I1, typename I2, typename T, class R, class F>
+	static T binary( I1 first1, I1 last1, I2 first2, T init, R reduce, F transform )
+	{
+		const binary_access<I1, I2, F, T> at = { first1, first2, transform };
+		return reduce_access( at, std::size_t( last1 - first1 ), init, reduce );
+	}
+
+	template<typename I, typename T, class R, class F>
+	static T unary( I first, I last, T init, R reduce, F transform )
+	{
+		const unary_access<I, F, T> at = { first, transform };
+		return reduce_access( at, std::size_t( last - first ), init, reduce );
+	}
+};
+
+char random_access_test( std::random_access_iterator_tag );
+long random_access_test( ... );
+
+template<typename I>
+struct is_random_access
+{
+	static const bool value = sizeof( random_access_test( typename std::iterator_traits<I>::iterator_category() ) ) == sizeof( char );
+};
+
+}
+
+template<typename I1, typename I2, typename T>
+T transform_reduce( I1 first1, I1 last1, I2 first2, T init )
+{
+	return ot::transform_reduce( first1, last1, first2, init, plus<T>(), multiplies<typename std::iterator_traits<I1>::value_type, typename std::iterator_traits<I2>::value_type>() );
+}
+
+template<typename I1, typename I2, typename T, class R, class F>
+T transform_reduce( I1 first1, I1 last1, I2 first2, T init, R reduce, F transform )
+{
+	return detail::transform_reduce_impl<reduction_traits<R>::associative
+		&& detail::is_random_access<I1>::value && detail::is_random_access<I2>::value>
+		::binary( first1, last1, first2, init, reduce, transform );
+}
+
+template<typename I, typename T, class R, class F>
+T transform_reduce( I first, I last, T init, R reduce, F transform )
+{
+	return detail::transform_reduce_impl<reduction_traits<R>::associative
+		&& detail::is_random_access<I>::value>
+		::unary( first, last, init, reduce, transform );
+}
+
+#if __cplusplus > 201100L || __GXX_EXPERIMENTAL_CXX0X__
+
+namespace detail
+{
+
+template<typename T, class R, class A>
+T parallel_reduce_access( thread_pool & pool, const A & at, std::size_t n, T init, R reduce )
+{
+	if ( n == 0 ) return init;
+	const std::size_t blocks = ( n + OT_REDUCE_BLOCK_SIZE - 1 ) / OT_REDUCE_BLOCK_SIZE;
+	if ( blocks == 1 || pool.size() == 1 ) return reduce( init, reduce_blocks<T>( at, n, 0, blocks, reduce ) );
+
+	std::vector<T> partials( blocks );
+	pool.parallel_for( std::size_t( 0 ), blocks, [&] ( std::size_t first, std::size_t last )
+	{
+		for ( std::size_t b = first; b < last; ++b ) partials[b] = reduce_blocks<T>( at, n, b, b + 1, reduce );
+	}, 1 );
+	return reduce( init, reduce_partials( partials, 0, blocks, reduce ) );
+}
+
+}
+
+template<typename I1, typename I2, typename T>
+T transform_reduce( thread_pool & pool, I1 first1, I1 last1, I2 first2, T init )
+{
+	return ot::transform_reduce( pool, first1, last1, first2, init, plus<T>(), multiplies<typename std::iterator_traits<I1>::value_type, typename std::iterator_traits<I2>::value_type>() );
+}
+
+template<typename I1, typename I2, typename T, class R, class F>
+T transform_reduce( thread_pool & pool, I1 first1, I1 last1, I2 first2, T init, R reduce, F transform )
+{
+	static_assert( reduction_traits<R>::associative, "ot::transform_reduce: parallel reduction requires an associative functor" );
+	const detail::binary_access<I1, I2, F, T> at = { first1, first2, transform };
+	return detail::parallel_reduce_access( pool, at, std::size_t( last1 - first1 ), init, reduce );
+}
+
+template<typename I, typename T, class R, class F>
+T transform_reduce( thread_pool & pool, I first, I last, T init, R reduce, F transform )
+{
+	static_assert( reduction_traits<R>::associative, "ot::transform_reduce: parallel reduction requires an associative functor" );
+	const detail::unary_access<I, F, T> at = { first, transform };
+	return detail::parallel_reduce_access( pool, at, std::size_t( last - first ), init, reduce );
+}
+
+#endif
+
+}
+
+#endif
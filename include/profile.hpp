@@ -0,0 +1,448 @@
+/*
+	Copyright (c) 2012 Charly LERSTEAU
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef OT_PROFILE_HPP
+#define OT_PROFILE_HPP
+
+#if !( __cplusplus > 201100L || __GXX_EXPERIMENTAL_CXX0X__ )
+#error "profile.hpp requires C++11."
+#endif
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <ostream>
+#include <stdexcept>
+#include <stdint.h>
+#include <utility>
+#include "function.hpp"
+
+/*
+	Macro: OT_NO_PROFILE
+
+	If defined, <profiled_function> does not measure latencies: it only
+	counts evaluations and enforces budgets.
+*/
+
+namespace ot
+{
+
+/*
+	Class: latency_histogram
+
+	Histogram of durations in nanoseconds, in the manner of HdrHistogram:
+	buckets are linear below 64 ns, then each power of two is split into
+	32 sub-buckets, so that recorded values are kept within 3%.
+
+	Buckets are relaxed atomic counters, so that a histogram can be read
+	while another thread records into it.
+*/
+
+class latency_histogram
+{
+public:
+	static const unsigned sub_bucket_bits  = 5;
+	static const unsigned sub_bucket_count = 1u << sub_bucket_bits;
+	static const unsigned bucket_count     = ( 64 - sub_bucket_bits + 1 ) * sub_bucket_count;
+
+	latency_histogram() { reset(); }
+
+	void record( uint64_t ns );
+	void merge( const latency_histogram & h );
+	void reset();
+
+	uint64_t count() const { return _count.load( std::memory_order_relaxed ); }
+	uint64_t total() const { return _total.load( std::memory_order_relaxed ); }
+	uint64_t min() const { return _min.load( std::memory_order_relaxed ); }
+	uint64_t max() const { return _max.load( std::memory_order_relaxed ); }
+	double mean() const { return count() > 0 ? double( total() ) / double( count() ) : 0.0; }
+	uint64_t percentile( double p ) const;
+
+	static unsigned index( uint64_t ns );
+	static uint64_t lower_bound( unsigned i );
+	static uint64_t upper_bound( unsigned i );
+
+private:
+	latency_histogram( const latency_histogram & );
+	latency_histogram & operator = ( const latency_histogram & );
+
+	std::atomic<uint64_t> _buckets[bucket_count];
+	std::atomic<uint64_t> _count;
+	std::atomic<uint64_t> _total;
+	std::atomic<uint64_t> _min;
+	std::atomic<uint64_t> _max;
+};
+
+/*
+	Struct: evaluation_budget
+
+	Maximum number of evaluations and wall-clock seconds, 0 for no limit.
+*/
+
+struct evaluation_budget
+{
+	uint64_t evaluations;
+	double   seconds;
+
+	evaluation_budget( uint64_t e = 0, double s = 0.0 ) : evaluations( e ), seconds( s ) {}
+};
+
+/*
+	Class: budget_exceeded
+
+	Thrown by a <profiled_function> whose budget is exhausted.
+*/
+
+class budget_exceeded : public std::runtime_error
+{
+public:
+	budget_exceeded() : std::runtime_error( "ot::budget_exceeded" ) {}
+};
+
+/*
+	Struct: profile_summary
+
+	Evaluations, elapsed time and latency percentiles in nanoseconds.
+*/
+
+struct profile_summary
+{
+	uint64_t evaluations;
+	double   seconds;
+	bool     exhausted;
+	uint64_t min;
+	double   mean;
+	uint64_t p50;
+	uint64_t p90;
+	uint64_t p99;
+	uint64_t p999;
+	uint64_t max;
+};
+
+/*
+	Class: profiled_function<R(Args...)>
+
+	Wraps a function to count its evaluations, measure their latencies and
+	enforce an <evaluation_budget>.
+
+	Each thread records into its own histogram, allocated on its first
+	call; the histograms are merged on read. Once the budget is exhausted,
+	calls either throw <budget_exceeded> (policy throw_exception), or
+	still evaluate and raise the <exhausted> flag (policy signal), which a
+	solver polls to stop.
+*/
+
+template<typename Signature>
+class profiled_function;
+
+template<typename R, typename... Args>
+class profiled_function<R(Args...)>
+{
+public:
+	typedef R result_type;
+	typedef function<R(Args...)> function_type;
+
+	enum policy_type { throw_exception, signal };
+
+	static const std::size_t max_threads = 64;
+
+	explicit profiled_function( function_type f, evaluation_budget budget = evaluation_budget(), policy_type policy = throw_exception );
+	~profiled_function();
+
+	R operator () ( Args... args ) const;
+
+	bool exhausted() const { return _exhausted.load( std::memory_order_relaxed ); }
+	uint64_t evaluations() const { return _evaluations.load( std::memory_order_relaxed ); }
+	double seconds() const;
+
+	void latencies( latency_histogram & h ) const;
+	profile_summary summary() const;
+	void restart();
+
+private:
+	profiled_function( const profiled_function & );
+	profiled_function & operator = ( const profiled_function & );
+
+	typedef std::chrono::steady_clock clock_type;
+
+	struct scope
+	{
+		const profiled_function * owner;
+		clock_type::time_point    start;
+
+		~scope() { owner->histogram().record( uint64_t( std::chrono::duration_cast<std::chrono::nanoseconds>( clock_type::now() - start ).count() ) ); }
+	};
+
+	void account() const;
+	latency_histogram & histogram() const;
+
+	function_type                                   _function;
+	evaluation_budget                               _budget;
+	policy_type                                     _policy;
+	clock_type::time_point                          _start;
+	mutable std::atomic<uint64_t>                   _evaluations;
+	mutable std::atomic<bool>                       _exhausted;
+	mutable std::atomic<latency_histogram *>        _histograms[max_threads];
+};
+
+inline std::ostream & operator << ( std::ostream & os, const profile_summary & s );
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace detail
+{
+
+inline unsigned highest_bit( uint64_t x )
+{
+#if defined( __GNUC__ )
+	return 63 - __builtin_clzll( x );
+#else
+	unsigned r = 0;
+	while ( x >>= 1 ) ++r;
+	return r;
+#endif
+}
+
+// Small index of the calling thread, to pick its histogram.
+inline std::size_t profile_thread_index()
+{
+	static std::atomic<std::size_t> next( 0 );
+	static thread_local std::size_t index = next++;
+	return index;
+}
+
+}
+
+inline unsigned latency_histogram::index( uint64_t ns )
+{
+	if ( ns < 2 * sub_bucket_count ) return unsigned( ns );
+	const unsigned shift = detail::highest_bit( ns ) - sub_bucket_bits;
+	return shift * sub_bucket_count + unsigned( ns >> shift );
+}
+
+inline uint64_t latency_histogram::lower_bound( unsigned i )
+{
+	if ( i < 2 * sub_bucket_count ) return i;
+	const unsigned shift = i / sub_bucket_count - 1;
+	return uint64_t( i - shift * sub_bucket_count ) << shift;
+}
+
+inline uint64_t latency_histogram::upper_bound( unsigned i )
+{
+	if ( i < 2 * sub_bucket_count ) return i;
+	const unsigned shift = i / sub_bucket_count - 1;
+	return ( uint64_t( i - shift * sub_bucket_count + 1 ) << shift ) - 1;
+}
+
+inline void latency_histogram::record( uint64_t ns )
+{
+	_buckets[index( ns )].fetch_add( 1, std::memory_order_relaxed );
+	_count.fetch_add( 1, std::memory_order_relaxed );
+	_total.fetch_add( ns, std::memory_order_relaxed );
+
+	uint64_t m = _min.load( std::memory_order_relaxed );
+	while ( ns < m && !_min.compare_exchange_weak( m, ns, std::memory_order_relaxed ) ) {}
+	m = _max.load( std::memory_order_relaxed );
+	while ( ns > m && !_max.compare_exchange_weak( m, ns, std::memory_order_relaxed ) ) {}
+}
+
+inline void latency_histogram::merge( const latency_histogram & h )
+{
+	for ( unsigned i = 0; i < bucket_count; ++i )
+	{
+		const uint64_t c = h._buckets[i].load( std::memory_order_relaxed );
+		if ( c > 0 ) _buckets[i].fetch_add( c, std::memory_order_relaxed );
+	}
+	_count.fetch_add( h.count(), std::memory_order_relaxed );
+	_total.fetch_add( h.total(), std::memory_order_relaxed );
+	if ( h.min() < min() ) _min.store( h.min(), std::memory_order_relaxed );
+	if ( h.max() > max() ) _max.store( h.max(), std::memory_order_relaxed );
+}
+
+inline void latency_histogram::reset()
+{
+	for ( unsigned i = 0; i < bucket_count; ++i ) _buckets[i].store( 0, std::memory_order_relaxed );
+	_count.store( 0, std::memory_order_relaxed );
+	_total.store( 0, std::memory_order_relaxed );
+	_min.store( UINT64_MAX, std::memory_order_relaxed );
+	_max.store( 0, std::memory_order_relaxed );
+}
+
+/*
+	Method: percentile
+
+	Upper bound of the bucket holding the p-th percentile (p in [0,100]),
+	clamped to the maximum recorded value.
+*/
+
+inline uint64_t latency_histogram::percentile( double p ) const
+{
+	const uint64_t n = count();
+	if ( n == 0 ) return 0;
+
+	uint64_t rank = uint64_t( p / 100.0 * double( n ) + 0.5 );
+	if ( rank < 1 ) rank = 1;
+	if ( rank > n ) rank = n;
+
+	uint64_t seen = 0;
+	for ( unsigned i = 0; i < bucket_count; ++i )
+	{
+		seen += _buckets[i].load( std::memory_order_relaxed );
+		if ( seen >= rank )
+		{
+			const uint64_t u = upper_bound( i );
+			return u < max() ? u : max();
+		}
+	}
+	return max();
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+template<typename R, typename... Args>
+profiled_function<R(Args...)>::profiled_function( function_type f, evaluation_budget budget, policy_type policy ) : _function( std::move( f ) ), _budget( budget ), _policy( policy ), _start( clock_type::now() ), _evaluations( 0 ), _exhausted( false )
+{
+	for ( std::size_t i = 0; i < max_threads; ++i ) _histograms[i].store( 0 );
+}
+
+template<typename R, typename... Args>
+profiled_function<R(Args...)>::~profiled_function()
+{
+	for ( std::size_t i = 0; i < max_threads; ++i ) delete _histograms[i].load();
+}
+
+template<typename R, typename... Args>
+R profiled_function<R(Args...)>::operator () ( Args... args ) const
+{
+	account();
+#ifndef OT_NO_PROFILE
+	const scope s = { this, clock_type::now() };
+#endif
+	return _function( std::forward<Args>( args )... );
+}
+
+template<typename R, typename... Args>
+void profiled_function<R(Args...)>::account() const
+{
+	const uint64_t n = _evaluations.fetch_add( 1, std::memory_order_relaxed ) + 1;
+
+	bool over = ( _budget.evaluations > 0 && n > _budget.evaluations )
+		|| ( _budget.seconds > 0.0 && seconds() > _budget.seconds );
+
+	if ( !over ) return;
+
+	_exhausted.store( true, std::memory_order_relaxed );
+	if ( _policy == throw_exception )
+	{
+		_evaluations.fetch_sub( 1, std::memory_order_relaxed );
+		throw budget_exceeded();
+	}
+}
+
+template<typename R, typename... Args>
+latency_histogram & profiled_function<R(Args...)>::histogram() const
+{
+	std::atomic<latency_histogram *> & slot = _histograms[detail::profile_thread_index() % max_threads];
+
+	latency_histogram * h = slot.load( std::memory_order_acquire );
+	if ( h ) return *h;
+
+	// First call from this thread: publish a new histogram, unless another
+	// thread sharing the slot was faster.
+	latency_histogram * n = new latency_histogram;
+	if ( slot.compare_exchange_strong( h, n, std::memory_order_acq_rel ) ) return *n;
+	delete n;
+	return *h;
+}
+
+template<typename R, typename... Args>
+double profiled_function<R(Args...)>::seconds() const
+{
+	return std::chrono::duration<double>( clock_type::now() - _start ).count();
+}
+
+/*
+	Method: latencies
+
+	Merges the histograms of all threads into h.
+*/
+
+template<typename R, typename... Args>
+void profiled_function<R(Args...)>::latencies( latency_histogram & h ) const
+{
+	for ( std::size_t i = 0; i < max_threads; ++i )
+	{
+		if ( const latency_histogram * p = _histograms[i].load( std::memory_order_acquire ) ) h.merge( *p );
+	}
+}
+
+template<typename R, typename... Args>
+profile_summary profiled_function<R(Args...)>::summary() const
+{
+	latency_histogram h;
+	latencies( h );
+
+	profile_summary s;
+	s.evaluations = evaluations();
+	s.seconds     = seconds();
+	s.exhausted   = exhausted();
+	s.min         = h.count() > 0 ? h.min() : 0;
+	s.mean        = h.mean();
+	s.p50         = h.percentile( 50.0 );
+	s.p90         = h.percentile( 90.0 );
+	s.p99         = h.percentile( 99.0 );
+	s.p999        = h.percentile( 99.9 );
+	s.max         = h.max();
+	return s;
+}
+
+/*
+	Method: restart
+
+	Resets the counters, the histograms and the clock of the budget.
+	Not thread-safe.
+*/
+
+template<typename R, typename... Args>
+void profiled_function<R(Args...)>::restart()
+{
+	for ( std::size_t i = 0; i < max_threads; ++i )
+	{
+		if ( latency_histogram * p = _histograms[i].load() ) p->reset();
+	}
+	_evaluations = 0;
+	_exhausted   = false;
+	_start       = clock_type::now();
+}
+
+inline std::ostream & operator << ( std::ostream & os, const profile_summary & s )
+{
+	return os << "evaluations: " << s.evaluations
+		<< ", seconds: " << s.seconds
+		<< ( s.exhausted ? " (budget exhausted)" : "" )
+		<< ", latency (ns): min " << s.min
+		<< ", mean " << s.mean
+		<< ", p50 " << s.p50
+		<< ", p90 " << s.p90
+		<< ", p99 " << s.p99
+		<< ", p99.9 " << s.p999
+		<< ", max " << s.max;
+}
+
+}
+
+#endif
@@ -18,12 +18,58 @@
 #ifndef OT_RANDOM_HPP
 #define OT_RANDOM_HPP
 
+#include <algorithm>
+#include <cmath>
 #include <cstdlib>
+#include <cstring>
+#include <istream>
+#include <iterator>
+#include <new>
+#include <ostream>
 #include <stdint.h>
+#include <vector>
+
+// Definition of __ot_random_cxx11 : true if C++11 features are available.
+#if __cplusplus > 201100L || __GXX_EXPERIMENTAL_CXX0X__
+#include <initializer_list>
+#define __ot_random_cxx11 1
+#endif
 
 namespace ot
 {
 
+/*
+	Class: seed_seq
+
+	(C++11) Generates well-distributed seed words for engines from a
+	sequence of integers, with the same algorithm as std::seed_seq, so
+	that engines seeded from it match their std counterparts.
+*/
+class seed_seq
+{
+public:
+	typedef uint32_t result_type;
+
+	seed_seq() {}
+	template<typename I>
+	seed_seq( I first, I last ) : _v( first, last ) {}
+#ifdef __ot_random_cxx11
+	template<typename T>
+	seed_seq( std::initializer_list<T> il ) : _v( il.begin(), il.end() ) {}
+#endif
+
+	template<typename I>
+	void generate( I first, I last ) const;
+
+	std::size_t size() const { return _v.size(); }
+
+	template<typename O>
+	void param( O out ) const { std::copy( _v.begin(), _v.end(), out ); }
+
+private:
+	std::vector<result_type> _v;
+};
+
 /*
 	Class: linear_congruential_engine<...>
 
@@ -41,15 +87,34 @@ public:
 	static const result_type default_seed = 1u;
 
 	explicit linear_congruential_engine( result_type value = default_seed );
+	explicit linear_congruential_engine( seed_seq & q );
 	void seed( result_type value = default_seed );
+	void seed( seed_seq & q );
 
 	result_type operator () ();
 	void discard( unsigned long z );
 
+	void save( std::ostream & os ) const;
+	void load( std::istream & is );
+
 	static result_type min();
 	static result_type max();
 
+	friend std::ostream & operator << ( std::ostream & os, const linear_congruential_engine & e )
+	{
+		return os << e._data;
+	}
+
+	friend std::istream & operator >> ( std::istream & is, linear_congruential_engine & e )
+	{
+		result_type x;
+		if ( is >> x ) e._data = x;
+		return is;
+	}
+
 private:
+	static uint64_t signature();
+
 	result_type _data;
 };
 
@@ -97,15 +162,52 @@ public:
 	static const result_type default_seed              = 5489u;
 
 	explicit mersenne_twister_engine( result_type value = default_seed );
+	explicit mersenne_twister_engine( seed_seq & q );
 	void seed( result_type value = default_seed );
+	void seed( seed_seq & q );
 
 	result_type operator () ();
 	void discard( unsigned long z );
 
+	void save( std::ostream & os ) const;
+	void load( std::istream & is );
+
 	static result_type min();
 	static result_type max();
 
+	// Text format: the position in the state, then the N state words.
+	friend std::ostream & operator << ( std::ostream & os, const mersenne_twister_engine & e )
+	{
+		os << e.index;
+		for ( std::size_t i = 0; i < N; ++i )
+		{
+			os << ' ' << e.MT[i];
+		}
+		return os;
+	}
+
+	friend std::istream & operator >> ( std::istream & is, mersenne_twister_engine & e )
+	{
+		std::size_t position;
+		result_type state[N];
+
+		is >> position;
+		for ( std::size_t i = 0; i < N && is; ++i )
+		{
+			is >> state[i];
+		}
+		if ( is && position > N ) is.setstate( std::ios::failbit );
+		if ( is )
+		{
+			e.index = position;
+			std::copy( state, state + N, e.MT );
+		}
+		return is;
+	}
+
 private:
+	static uint64_t signature();
+
 	static const result_type MASK  = ~((~0ul-1ul) << (W-1));
 	static const result_type UMASK = ( ~UINT() ) << R;
 	static const result_type LMASK = ~UMASK;
@@ -151,18 +253,354 @@ typedef minstd_rand0 default_random_engine;
 
 ////////////////////////////////////////////////////////////////////////////////
 
+/*
+	Class: uniform_int_distribution<INT>
+
+	(C++11) Produces integer values uniformly distributed on the closed interval [a, b].
+
+	Engines producing full 32-bit words (e.g. <mt19937>) use Lemire's
+	nearly-divisionless method: one multiplication per draw, and a division
+	only in the rare case where the draw may be biased. Other engines fall
+	back to rejection with downscaling.
+
+	See:
+		D. Lemire, Fast Random Integer Generation in an Interval, 2019.
+*/
+template<typename INT = int>
+class uniform_int_distribution
+{
+public:
+	typedef INT result_type;
+
+	explicit uniform_int_distribution( result_type a = 0, result_type b = 0x7fffffff );
+	void reset() {}
+
+	template<class G>
+	result_type operator () ( G & g ) const;
+
+	template<typename I, class G>
+	void generate( I first, I last, G & g ) const;
+
+	result_type a() const { return _a; }
+	result_type b() const { return _b; }
+	result_type min() const { return _a; }
+	result_type max() const { return _b; }
+
+private:
+	result_type _a;
+	result_type _b;
+};
+
+/*
+	Class: uniform_real_distribution<REAL>
+
+	(C++11) Produces real values uniformly distributed on the interval [a, b).
+
+	With engines producing full 32-bit words, the random bits are written
+	directly into the mantissa of a number in [1, 2), which avoids the
+	integer-to-floating-point conversion and the division.
+*/
+template<typename REAL = double>
+class uniform_real_distribution
+{
+public:
+	typedef REAL result_type;
+
+	explicit uniform_real_distribution( result_type a = 0, result_type b = 1 );
+	void reset() {}
+
+	template<class G>
+	result_type operator () ( G & g ) const;
+
+	template<typename I, class G>
+	void generate( I first, I last, G & g ) const;
+
+	result_type a() const { return _a; }
+	result_type b() const { return _b; }
+	result_type min() const { return _a; }
+	result_type max() const { return _b; }
+
+private:
+	result_type _a;
+	result_type _b;
+};
+
+/*
+	Class: normal_distribution<REAL>
+
+	(C++11) Produces real values according to a normal distribution,
+	using the ziggurat method of Marsaglia and Tsang (128 layers).
+
+	See:
+		G. Marsaglia, W. W. Tsang, The Ziggurat Method for Generating Random Variables, 2000.
+*/
+template<typename REAL = double>
+class normal_distribution
+{
+public:
+	typedef REAL result_type;
+
+	explicit normal_distribution( result_type mean = 0, result_type stddev = 1 );
+	void reset() {}
+
+	template<class G>
+	result_type operator () ( G & g ) const;
+
+	template<typename I, class G>
+	void generate( I first, I last, G & g ) const;
+
+	result_type mean() const { return _mean; }
+	result_type stddev() const { return _stddev; }
+
+private:
+	result_type _mean;
+	result_type _stddev;
+};
+
+/*
+	Class: exponential_distribution<REAL>
+
+	(C++11) Produces real values according to an exponential distribution,
+	using the ziggurat method of Marsaglia and Tsang (256 layers).
+*/
+template<typename REAL = double>
+class exponential_distribution
+{
+public:
+	typedef REAL result_type;
+
+	explicit exponential_distribution( result_type lambda = 1 );
+	void reset() {}
+
+	template<class G>
+	result_type operator () ( G & g ) const;
+
+	template<typename I, class G>
+	void generate( I first, I last, G & g ) const;
+
+	result_type lambda() const { return _lambda; }
+
+private:
+	result_type _lambda;
+};
+
+/*
+	Class: discrete_distribution<INT>
+
+	(C++11) Produces integer values on the interval [0, n) with
+	probabilities proportional to given weights, in O(1) per draw
+	using Vose's alias method.
+
+	The weights may be split into blocks of a given size, each block having
+	its own alias table, and a top-level alias table selecting the block.
+	Then <update> only rebuilds the block of the modified weight and the
+	top-level table, in O(block_size + n / block_size) instead of O(n),
+	at the cost of one extra draw per sample. By default there is a single
+	block and every draw costs one bounded integer and one random word.
+
+	See:
+		M. D. Vose, A Linear Algorithm for Generating Random Numbers with a Given Distribution, 1991.
+*/
+template<typename INT = int>
+class discrete_distribution
+{
+public:
+	typedef INT result_type;
+
+	discrete_distribution();
+	template<typename I>
+	discrete_distribution( I first, I last, std::size_t block_size = 0 );
+	void reset() {}
+
+	template<class G>
+	result_type operator () ( G & g ) const;
+
+	template<typename I, class G>
+	void generate( I first, I last, G & g ) const;
+
+	void update( std::size_t i, double weight );
+
+	std::vector<double> probabilities() const;
+	result_type min() const { return 0; }
+	result_type max() const { return result_type( _weights.size() - 1 ); }
+
+private:
+	void build_block( std::size_t b );
+	void build_top();
+
+	static void build( const double * weights, std::size_t n, double sum,
+		uint32_t * prob, uint32_t * alias, uint32_t offset );
+
+	template<class G>
+	static uint32_t sample( const uint32_t * prob, const uint32_t * alias, uint32_t n, uint32_t offset, G & g );
+
+	std::size_t           _block_size;
+	std::vector<double>   _weights;
+	std::vector<uint32_t> _prob;
+	std::vector<uint32_t> _alias;
+	std::vector<double>   _block_sum;
+	std::vector<uint32_t> _block_prob;
+	std::vector<uint32_t> _block_alias;
+};
+
+/*
+	Class: engine_pool<E>
+
+	A fixed set of engines, one per worker, each on its own cache line so
+	that workers drawing concurrently do not share cache lines.
+
+	Engine i is seeded once from a <seed_seq> made of the master seed and i,
+	so that a run is replayed exactly from the master seed as long as
+	worker i handles the same tasks in the same order. Engines are meant
+	to be reused across tasks, which avoids paying the seeding cost of
+	large engines (O(N) for <mersenne_twister_engine>) for each task.
+*/
+template<class E>
+class engine_pool
+{
+public:
+	typedef E engine_type;
+
+	static const std::size_t cache_line_size = 64;
+
+	explicit engine_pool( std::size_t size, uint64_t master_seed = 0 );
+	~engine_pool();
+
+	void seed( uint64_t master_seed );
+
+	engine_type & operator [] ( std::size_t i ) { return *engine( i ); }
+	const engine_type & operator [] ( std::size_t i ) const { return *engine( i ); }
+
+	std::size_t size() const { return _size; }
+	uint64_t master_seed() const { return _master_seed; }
+
+private:
+	engine_pool( const engine_pool & );
+	engine_pool & operator = ( const engine_pool & );
+
+	// Distance between two engines, rounded up to whole cache lines.
+	static const std::size_t stride = ( ( sizeof( E ) + cache_line_size - 1 ) / cache_line_size ) * cache_line_size;
+
+	engine_type * engine( std::size_t i ) const { return reinterpret_cast<engine_type *>( _data + i * stride ); }
+
+	std::size_t _size;
+	uint64_t    _master_seed;
+	char      * _buffer;
+	char      * _data;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace detail
+{
+
+/*
+	Binary format of saved engine states, in native byte order:
+
+	- magic "otre" (4 bytes),
+	- format version (uint32),
+	- signature of the engine type and parameters (uint64),
+	- size of a state word in bytes (uint32),
+	- number of state words (uint32),
+	- position in the state (uint64),
+	- state words.
+*/
+struct state_header
+{
+	static const uint32_t version = 1;
+
+	uint64_t signature;
+	uint32_t word_size;
+	uint32_t state_size;
+	uint64_t position;
+};
+
+// FNV-1a hash of a 64-bit value, used to build engine signatures.
+inline uint64_t hash_combine( uint64_t h, uint64_t x )
+{
+	for ( int i = 0; i < 8; ++i, x >>= 8 )
+	{
+		h = ( h ^ ( x & 0xffu ) ) * UINT64_C(0x100000001b3);
+	}
+	return h;
+}
+
+inline void write_state_header( std::ostream & os, const state_header & h )
+{
+	const uint32_t version = state_header::version;
+	os.write( "otre", 4 );
+	os.write( reinterpret_cast<const char *>( &version ), sizeof( version ) );
+	os.write( reinterpret_cast<const char *>( &h.signature ), sizeof( h.signature ) );
+	os.write( reinterpret_cast<const char *>( &h.word_size ), sizeof( h.word_size ) );
+	os.write( reinterpret_cast<const char *>( &h.state_size ), sizeof( h.state_size ) );
+	os.write( reinterpret_cast<const char *>( &h.position ), sizeof( h.position ) );
+}
+
+// Reads a header and checks it against the expected one, except for the
+// position. Sets failbit on mismatch.
+inline bool read_state_header( std::istream & is, state_header & h )
+{
+	char magic[4];
+	uint32_t version;
+	state_header r;
+
+	is.read( magic, 4 );
+	is.read( reinterpret_cast<char *>( &version ), sizeof( version ) );
+	is.read( reinterpret_cast<char *>( &r.signature ), sizeof( r.signature ) );
+	is.read( reinterpret_cast<char *>( &r.word_size ), sizeof( r.word_size ) );
+	is.read( reinterpret_cast<char *>( &r.state_size ), sizeof( r.state_size ) );
+	is.read( reinterpret_cast<char *>( &r.position ), sizeof( r.position ) );
+
+	if ( is && ( std::memcmp( magic, "otre", 4 ) != 0 || version != state_header::version
+		|| r.signature != h.signature || r.word_size != h.word_size || r.state_size != h.state_size ) )
+	{
+		is.setstate( std::ios::failbit );
+	}
+	h.position = r.position;
+	return bool( is );
+}
+
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
 template<typename UINT, UINT A, UINT C, UINT M>
 linear_congruential_engine<UINT,A,C,M>::linear_congruential_engine( result_type value )
 {
 	seed( value );
 }
 
+template<typename UINT, UINT A, UINT C, UINT M>
+linear_congruential_engine<UINT,A,C,M>::linear_congruential_engine( seed_seq & q )
+{
+	seed( q );
+}
+
 template<typename UINT, UINT A, UINT C, UINT M>
 void linear_congruential_engine<UINT,A,C,M>::seed( result_type value )
 {
 	_data = ( increment % modulus == 0 && value % modulus == 0 ) ? default_seed : ( value % modulus );
 }
 
+template<typename UINT, UINT A, UINT C, UINT M>
+void linear_congruential_engine<UINT,A,C,M>::seed( seed_seq & q )
+{
+	// k = ceil(log2(modulus) / 32) words, after 3 discarded words.
+	std::size_t bits = 0;
+	while ( bits < 64 && ( uint64_t( 1 ) << bits ) < uint64_t( modulus ) ) ++bits;
+	const std::size_t k = ( bits + 31 ) / 32;
+
+	uint32_t a[2 + 3];
+	q.generate( a, a + k + 3 );
+
+	uint64_t sum = 0;
+	for ( std::size_t j = k; j-- > 0; )
+	{
+		sum = ( ( sum << 16 << 16 ) + a[j + 3] ) % modulus;
+	}
+	_data = ( increment % modulus == 0 && sum == 0 ) ? 1u : result_type( sum );
+}
+
 template<typename UINT, UINT A, UINT C, UINT M>
 typename linear_congruential_engine<UINT,A,C,M>::result_type linear_congruential_engine<UINT,A,C,M>::operator () ()
 {
@@ -201,6 +639,36 @@ void linear_congruential_engine<UINT,A,C,M>::discard( unsigned long z )
 	}
 }
 
+template<typename UINT, UINT A, UINT C, UINT M>
+void linear_congruential_engine<UINT,A,C,M>::save( std::ostream & os ) const
+{
+	detail::state_header h = { signature(), uint32_t( sizeof( result_type ) ), 1, 0 };
+	detail::write_state_header( os, h );
+	os.write( reinterpret_cast<const char *>( &_data ), sizeof( _data ) );
+}
+
+template<typename UINT, UINT A, UINT C, UINT M>
+void linear_congruential_engine<UINT,A,C,M>::load( std::istream & is )
+{
+	detail::state_header h = { signature(), uint32_t( sizeof( result_type ) ), 1, 0 };
+	result_type x;
+
+	if ( !detail::read_state_header( is, h ) ) return;
+	is.read( reinterpret_cast<char *>( &x ), sizeof( x ) );
+	if ( is ) _data = x;
+}
+
+template<typename UINT, UINT A, UINT C, UINT M>
+uint64_t linear_congruential_engine<UINT,A,C,M>::signature()
+{
+	uint64_t h = UINT64_C(0xcbf29ce484222325);
+	h = detail::hash_combine( h, 1 ); // Engine kind.
+	h = detail::hash_combine( h, A );
+	h = detail::hash_combine( h, C );
+	h = detail::hash_combine( h, M );
+	return h;
+}
+
 template<typename UINT, UINT A, UINT C, UINT M>
 typename linear_congruential_engine<UINT,A,C,M>::result_type linear_congruential_engine<UINT,A,C,M>::min()
 {
@@ -236,6 +704,39 @@ void mersenne_twister_engine<UINT,W,N,M,R,A,U,D,S,B,T,C,L,F>::seed( result_type
 	index = state_size;
 }
 
+template<typename UINT, std::size_t W, std::size_t N, std::size_t M,
+	std::size_t R, UINT A, std::size_t U, UINT D, std::size_t S, UINT B,
+	std::size_t T, UINT C, std::size_t L, UINT F>
+mersenne_twister_engine<UINT,W,N,M,R,A,U,D,S,B,T,C,L,F>::mersenne_twister_engine( seed_seq & q )
+{
+	seed( q );
+}
+
+template<typename UINT, std::size_t W, std::size_t N, std::size_t M,
+	std::size_t R, UINT A, std::size_t U, UINT D, std::size_t S, UINT B,
+	std::size_t T, UINT C, std::size_t L, UINT F>
+void mersenne_twister_engine<UINT,W,N,M,R,A,U,D,S,B,T,C,L,F>::seed( seed_seq & q )
+{
+	const std::size_t k = ( W + 31 ) / 32;
+	uint32_t a[N * k];
+	q.generate( a, a + N * k );
+
+	bool zero = true;
+	for ( std::size_t i = 0; i < N; ++i )
+	{
+		uint64_t sum = 0;
+		for ( std::size_t j = k; j-- > 0; )
+		{
+			sum = ( sum << 16 << 16 ) | a[k * i + j];
+		}
+		MT[i] = result_type( sum ) & MASK;
+		zero = zero && ( ( i == 0 ) ? ( MT[0] & UMASK & MASK ) == 0 : MT[i] == 0 );
+	}
+	// All-zero states are invalid.
+	if ( zero ) MT[0] = result_type( 1 ) << ( W - 1 );
+	index = state_size;
+}
+
 template<typename UINT, std::size_t W, std::size_t N, std::size_t M,
 	std::size_t R, UINT A, std::size_t U, UINT D, std::size_t S, UINT B,
 	std::size_t T, UINT C, std::size_t L, UINT F>
@@ -282,6 +783,48 @@ void mersenne_twister_engine<UINT,W,N,M,R,A,U,D,S,B,T,C,L,F>::discard( unsigned
 	}
 }
 
+template<typename UINT, std::size_t W, std::size_t N, std::size_t M,
+	std::size_t R, UINT A, std::size_t U, UINT D, std::size_t S, UINT B,
+	std::size_t T, UINT C, std::size_t L, UINT F>
+void mersenne_twister_engine<UINT,W,N,M,R,A,U,D,S,B,T,C,L,F>::save( std::ostream & os ) const
+{
+	detail::state_header h = { signature(), uint32_t( sizeof( result_type ) ), uint32_t( N ), uint64_t( index ) };
+	detail::write_state_header( os, h );
+	os.write( reinterpret_cast<const char *>( MT ), sizeof( MT ) );
+}
+
+template<typename UINT, std::size_t W, std::size_t N, std::size_t M,
+	std::size_t R, UINT A, std::size_t U, UINT D, std::size_t S, UINT B,
+	std::size_t T, UINT C, std::size_t L, UINT F>
+void mersenne_twister_engine<UINT,W,N,M,R,A,U,D,S,B,T,C,L,F>::load( std::istream & is )
+{
+	detail::state_header h = { signature(), uint32_t( sizeof( result_type ) ), uint32_t( N ), 0 };
+	result_type state[N];
+
+	if ( !detail::read_state_header( is, h ) ) return;
+	is.read( reinterpret_cast<char *>( state ), sizeof( state ) );
+	if ( is && h.position > N ) is.setstate( std::ios::failbit );
+	if ( is )
+	{
+		index = std::size_t( h.position );
+		std::memcpy( MT, state, sizeof( MT ) );
+	}
+}
+
+template<typename UINT, std::size_t W, std::size_t N, std::size_t M,
+	std::size_t R, UINT A, std::size_t U, UINT D, std::size_t S, UINT B,
+	std::size_t T, UINT C, std::size_t L, UINT F>
+uint64_t mersenne_twister_engine<UINT,W,N,M,R,A,U,D,S,B,T,C,L,F>::signature()
+{
+	const uint64_t parameters[] = { 2, W, N, M, R, A, U, D, S, B, T, C, L, F }; // Engine kind first.
+	uint64_t h = UINT64_C(0xcbf29ce484222325);
+	for ( std::size_t i = 0; i < sizeof( parameters ) / sizeof( parameters[0] ); ++i )
+	{
+		h = detail::hash_combine( h, parameters[i] );
+	}
+	return h;
+}
+
 template<typename UINT, std::size_t W, std::size_t N, std::size_t M,
 	std::size_t R, UINT A, std::size_t U, UINT D, std::size_t S, UINT B,
 	std::size_t T, UINT C, std::size_t L, UINT F>
@@ -298,6 +841,699 @@ typename mersenne_twister_engine<UINT,W,N,M,R,A,U,D,S,B,T,C,L,F>::result_type me
 	return MASK;
 }
 
+////////////////////////////////////////////////////////////////////////////////
+
+template<typename I>
+void seed_seq::generate( I first, I last ) const
+{
+	const std::size_t n = std::size_t( std::distance( first, last ) );
+	if ( n == 0 ) return;
+
+	std::vector<uint32_t> b( n, 0x8b8b8b8bu );
+
+	const std::size_t s = _v.size();
+	const std::size_t t = ( n >= 623 ) ? 11 : ( n >= 68 ) ? 7 : ( n >= 39 ) ? 5 : ( n >= 7 ) ? 3 : ( n - 1 ) / 2;
+	const std::size_t p = ( n - t ) / 2;
+	const std::size_t q = p + t;
+	const std::size_t m = std::max( s + 1, n );
+
+	for ( std::size_t k = 0; k < m; ++k )
+	{
+		uint32_t x  = b[k % n] ^ b[( k + p ) % n] ^ b[( k + n - 1 ) % n];
+		uint32_t r1 = 1664525u * ( x ^ ( x >> 27 ) );
+		uint32_t r2 = r1 + ( ( k == 0 ) ? uint32_t( s ) : ( k <= s ) ? uint32_t( k % n ) + _v[k - 1] : uint32_t( k % n ) );
+		b[( k + p ) % n] += r1;
+		b[( k + q ) % n] += r2;
+		b[k % n] = r2;
+	}
+	for ( std::size_t k = m; k < m + n; ++k )
+	{
+		uint32_t x  = b[k % n] + b[( k + p ) % n] + b[( k + n - 1 ) % n];
+		uint32_t r3 = 1566083941u * ( x ^ ( x >> 27 ) );
+		uint32_t r4 = r3 - uint32_t( k % n );
+		b[( k + p ) % n] ^= r3;
+		b[( k + q ) % n] ^= r4;
+		b[k % n] = r4;
+	}
+	std::copy( b.begin(), b.end(), first );
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+template<class E>
+engine_pool<E>::engine_pool( std::size_t size, uint64_t master_seed ) : _size( size ), _master_seed( master_seed )
+{
+	_buffer = new char[_size * stride + cache_line_size];
+	_data   = _buffer + ( cache_line_size - reinterpret_cast<uintptr_t>( _buffer ) % cache_line_size ) % cache_line_size;
+
+	for ( std::size_t i = 0; i < _size; ++i )
+	{
+		new ( _data + i * stride ) engine_type();
+	}
+	seed( master_seed );
+}
+
+template<class E>
+engine_pool<E>::~engine_pool()
+{
+	for ( std::size_t i = 0; i < _size; ++i )
+	{
+		engine( i )->~engine_type();
+	}
+	delete [] _buffer;
+}
+
+template<class E>
+void engine_pool<E>::seed( uint64_t master_seed )
+{
+	_master_seed = master_seed;
+	for ( std::size_t i = 0; i < _size; ++i )
+	{
+		const uint32_t words[4] =
+		{
+			uint32_t( master_seed ), uint32_t( master_seed >> 32 ),
+			uint32_t( i ), uint32_t( uint64_t( i ) >> 16 >> 16 )
+		};
+		seed_seq q( words, words + 4 );
+		engine( i )->seed( q );
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace detail
+{
+
+// Checks if an engine produces uniform 32-bit words.
+template<class G>
+inline bool is_word32_engine()
+{
+	return G::min() == 0u && G::max() == 0xffffffffu;
+}
+
+// Draws an integer uniformly in [0, range] by rejection and downscaling.
+// Used for engines whose range is not a full machine word.
+template<class G>
+uint64_t generate_downscaled( G & g, uint64_t range )
+{
+	const uint64_t grange = uint64_t( G::max() ) - uint64_t( G::min() );
+	uint64_t r;
+
+	if ( grange > range )
+	{
+		const uint64_t erange  = range + 1u;
+		const uint64_t scaling = grange / erange;
+		const uint64_t past    = erange * scaling;
+		do
+		{
+			r = uint64_t( g() ) - uint64_t( G::min() );
+		}
+		while ( r >= past );
+		r /= scaling;
+	}
+	else if ( grange < range )
+	{
+		// Concatenate several draws: r = high * (grange + 1) + low.
+		const uint64_t gsize = grange + 1u;
+		uint64_t high;
+		do
+		{
+			high = gsize * generate_downscaled( g, range / gsize );
+			r = high + ( uint64_t( g() ) - uint64_t( G::min() ) );
+		}
+		while ( r > range || r < high );
+	}
+	else
+	{
+		r = uint64_t( g() ) - uint64_t( G::min() );
+	}
+	return r;
+}
+
+// Checks if an engine produces uniform 64-bit words.
+template<class G>
+inline bool is_word64_engine()
+{
+	return G::min() == 0u && uint64_t( G::max() ) == ~uint64_t( 0 );
+}
+
+// Returns 32 uniformly distributed random bits.
+template<class G>
+inline uint32_t generate_word32( G & g )
+{
+	if ( is_word32_engine<G>() ) return uint32_t( g() );
+	if ( is_word64_engine<G>() ) return uint32_t( uint64_t( g() ) >> 32 );
+	return uint32_t( generate_downscaled( g, 0xffffffffu ) );
+}
+
+// Returns 64 uniformly distributed random bits.
+template<class G>
+inline uint64_t generate_word64( G & g )
+{
+	if ( is_word64_engine<G>() ) return uint64_t( g() );
+	const uint64_t high = generate_word32( g );
+	return ( high << 32 ) | generate_word32( g );
+}
+
+// Maps random bits to a uniform value in [0, 1) by mantissa filling.
+inline double word_to_unit( uint64_t x )
+{
+	const uint64_t bits = UINT64_C(0x3ff0000000000000) | ( x >> 12 );
+	double d;
+	std::memcpy( &d, &bits, sizeof( d ) );
+	return d - 1.0;
+}
+
+inline float word_to_unit( uint32_t x )
+{
+	const uint32_t bits = UINT32_C(0x3f800000) | ( x >> 9 );
+	float f;
+	std::memcpy( &f, &bits, sizeof( f ) );
+	return f - 1.0f;
+}
+
+// Returns a uniform value in [0, 1) with the precision of REAL.
+template<typename REAL>
+struct unit_generator
+{
+	template<class G>
+	static REAL generate( G & g ) { return REAL( word_to_unit( generate_word64( g ) ) ); }
+};
+
+template<>
+struct unit_generator<float>
+{
+	template<class G>
+	static float generate( G & g ) { return word_to_unit( generate_word32( g ) ); }
+};
+
+// Lemire's nearly-divisionless bounded integer in [0, s), s > 0.
+// The threshold t = 2^32 mod s is only computed when needed.
+template<class G>
+inline uint32_t generate_bounded32( G & g, uint32_t s )
+{
+	uint64_t m = uint64_t( uint32_t( g() ) ) * s;
+	uint32_t l = uint32_t( m );
+	if ( l < s )
+	{
+		const uint32_t t = uint32_t( -s ) % s;
+		while ( l < t )
+		{
+			m = uint64_t( uint32_t( g() ) ) * s;
+			l = uint32_t( m );
+		}
+	}
+	return uint32_t( m >> 32 );
+}
+
+// Same as above with a precomputed threshold t = 2^32 mod s, for bulk generation.
+template<class G>
+inline uint32_t generate_bounded32( G & g, uint32_t s, uint32_t t )
+{
+	uint64_t m;
+	do
+	{
+		m = uint64_t( uint32_t( g() ) ) * s;
+	}
+	while ( uint32_t( m ) < t );
+	return uint32_t( m >> 32 );
+}
+
+// Draws two bounded integers r1 in [0, n1) and r2 in [0, n2) from a single
+// 32-bit word, where n1 * n2 < 2^32. The leftover of the first multiplication
+// feeds the second one, and a single threshold on the final leftover
+// removes the bias of both.
+//
+// See:
+//     N. Brackett-Rozinsky, D. Lemire, Batched Ranged Random Integer Generation, 2024.
+template<class G>
+inline void generate_bounded_pair32( G & g, uint32_t n1, uint32_t n2, uint32_t & r1, uint32_t & r2 )
+{
+	const uint32_t product = n1 * n2;
+	uint64_t m1 = uint64_t( uint32_t( g() ) ) * n1;
+	uint64_t m2 = uint64_t( uint32_t( m1 ) ) * n2;
+
+	if ( uint32_t( m2 ) < product )
+	{
+		const uint32_t t = uint32_t( -product ) % product;
+		while ( uint32_t( m2 ) < t )
+		{
+			m1 = uint64_t( uint32_t( g() ) ) * n1;
+			m2 = uint64_t( uint32_t( m1 ) ) * n2;
+		}
+	}
+	r1 = uint32_t( m1 >> 32 );
+	r2 = uint32_t( m2 >> 32 );
+}
+
+// Ziggurat tables for the normal distribution.
+struct normal_ziggurat
+{
+	uint32_t kn[128];
+	double   wn[128];
+	double   fn[128];
+
+	normal_ziggurat()
+	{
+		const double m1 = 2147483648.0;
+		const double vn = 9.91256303526217e-3;
+		double dn = 3.442619855899;
+		double tn = dn;
+		double q  = vn / std::exp( -0.5 * dn * dn );
+
+		kn[0]   = uint32_t( ( dn / q ) * m1 );
+		kn[1]   = 0;
+		wn[0]   = q / m1;
+		wn[127] = dn / m1;
+		fn[0]   = 1.0;
+		fn[127] = std::exp( -0.5 * dn * dn );
+
+		for ( int i = 126; i >= 1; --i )
+		{
+			dn = std::sqrt( -2.0 * std::log( vn / dn + std::exp( -0.5 * dn * dn ) ) );
+			kn[i+1] = uint32_t( ( dn / tn ) * m1 );
+			tn      = dn;
+			fn[i]   = std::exp( -0.5 * dn * dn );
+			wn[i]   = dn / m1;
+		}
+	}
+
+	static const normal_ziggurat & instance()
+	{
+		static const normal_ziggurat z;
+		return z;
+	}
+
+	// Absolute value of a signed 32-bit word, without overflow.
+	static uint32_t magnitude( int32_t x )
+	{
+		return x < 0 ? 0u - uint32_t( x ) : uint32_t( x );
+	}
+
+	template<class G>
+	double generate( G & g ) const
+	{
+		const int32_t hz = int32_t( generate_word32( g ) );
+		const int32_t iz = hz & 127;
+		if ( magnitude( hz ) < kn[iz] ) return hz * wn[iz];
+		return fix( g, hz, iz );
+	}
+
+	template<class G>
+	double fix( G & g, int32_t hz, int32_t iz ) const
+	{
+		const double r = 3.442619855899;
+		double x, y;
+
+		for ( ;; )
+		{
+			x = hz * wn[iz];
+
+			// Base strip: sample from the tail.
+			if ( iz == 0 )
+			{
+				do
+				{
+					x = -std::log( 1.0 - unit_generator<double>::generate( g ) ) / r;
+					y = -std::log( 1.0 - unit_generator<double>::generate( g ) );
+				}
+				while ( y + y < x * x );
+				return ( hz > 0 ) ? r + x : -r - x;
+			}
+
+			// Wedge.
+			if ( fn[iz] + unit_generator<double>::generate( g ) * ( fn[iz-1] - fn[iz] ) < std::exp( -0.5 * x * x ) ) return x;
+
+			hz = int32_t( generate_word32( g ) );
+			iz = hz & 127;
+			if ( magnitude( hz ) < kn[iz] ) return hz * wn[iz];
+		}
+	}
+};
+
+// Ziggurat tables for the exponential distribution.
+struct exponential_ziggurat
+{
+	uint32_t ke[256];
+	double   we[256];
+	double   fe[256];
+
+	exponential_ziggurat()
+	{
+		const double m2 = 4294967296.0;
+		const double ve = 3.949659822581572e-3;
+		double de = 7.697117470131487;
+		double te = de;
+		double q  = ve / std::exp( -de );
+
+		ke[0]   = uint32_t( ( de / q ) * m2 );
+		ke[1]   = 0;
+		we[0]   = q / m2;
+		we[255] = de / m2;
+		fe[0]   = 1.0;
+		fe[255] = std::exp( -de );
+
+		for ( int i = 254; i >= 1; --i )
+		{
+			de = -std::log( ve / de + std::exp( -de ) );
+			ke[i+1] = uint32_t( ( de / te ) * m2 );
+			te      = de;
+			fe[i]   = std::exp( -de );
+			we[i]   = de / m2;
+		}
+	}
+
+	static const exponential_ziggurat & instance()
+	{
+		static const exponential_ziggurat z;
+		return z;
+	}
+
+	template<class G>
+	double generate( G & g ) const
+	{
+		const uint32_t jz = generate_word32( g );
+		const uint32_t iz = jz & 255;
+		if ( jz < ke[iz] ) return jz * we[iz];
+		return fix( g, jz, iz );
+	}
+
+	template<class G>
+	double fix( G & g, uint32_t jz, uint32_t iz ) const
+	{
+		double x;
+
+		for ( ;; )
+		{
+			// Base strip: the tail is itself exponential.
+			if ( iz == 0 ) return 7.697117470131487 - std::log( 1.0 - unit_generator<double>::generate( g ) );
+
+			// Wedge.
+			x = jz * we[iz];
+			if ( fe[iz] + unit_generator<double>::generate( g ) * ( fe[iz-1] - fe[iz] ) < std::exp( -x ) ) return x;
+
+			jz = generate_word32( g );
+			iz = jz & 255;
+			if ( jz < ke[iz] ) return jz * we[iz];
+		}
+	}
+};
+
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+template<typename INT>
+uniform_int_distribution<INT>::uniform_int_distribution( result_type a, result_type b ) : _a( a ), _b( b )
+{
+}
+
+template<typename INT>
+template<class G>
+typename uniform_int_distribution<INT>::result_type uniform_int_distribution<INT>::operator () ( G & g ) const
+{
+	const uint64_t range = uint64_t( _b ) - uint64_t( _a );
+
+	if ( detail::is_word32_engine<G>() && range < 0xffffffffu )
+	{
+		return result_type( uint64_t( _a ) + detail::generate_bounded32( g, uint32_t( range + 1u ) ) );
+	}
+	return result_type( uint64_t( _a ) + detail::generate_downscaled( g, range ) );
+}
+
+template<typename INT>
+template<typename I, class G>
+void uniform_int_distribution<INT>::generate( I first, I last, G & g ) const
+{
+	const uint64_t range = uint64_t( _b ) - uint64_t( _a );
+
+	if ( detail::is_word32_engine<G>() && range < 0xffffffffu )
+	{
+		const uint32_t s = uint32_t( range + 1u );
+		const uint32_t t = uint32_t( -s ) % s;
+		for ( ; first != last; ++first )
+		{
+			*first = result_type( uint64_t( _a ) + detail::generate_bounded32( g, s, t ) );
+		}
+	}
+	else
+	{
+		for ( ; first != last; ++first )
+		{
+			*first = result_type( uint64_t( _a ) + detail::generate_downscaled( g, range ) );
+		}
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+template<typename REAL>
+uniform_real_distribution<REAL>::uniform_real_distribution( result_type a, result_type b ) : _a( a ), _b( b )
+{
+}
+
+template<typename REAL>
+template<class G>
+typename uniform_real_distribution<REAL>::result_type uniform_real_distribution<REAL>::operator () ( G & g ) const
+{
+	return _a + ( _b - _a ) * detail::unit_generator<REAL>::generate( g );
+}
+
+template<typename REAL>
+template<typename I, class G>
+void uniform_real_distribution<REAL>::generate( I first, I last, G & g ) const
+{
+	const result_type d = _b - _a;
+	for ( ; first != last; ++first )
+	{
+		*first = _a + d * detail::unit_generator<REAL>::generate( g );
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+template<typename REAL>
+normal_distribution<REAL>::normal_distribution( result_type mean, result_type stddev ) : _mean( mean ), _stddev( stddev )
+{
+}
+
+template<typename REAL>
+template<class G>
+typename normal_distribution<REAL>::result_type normal_distribution<REAL>::operator () ( G & g ) const
+{
+	return _mean + _stddev * result_type( detail::normal_ziggurat::instance().generate( g ) );
+}
+
+template<typename REAL>
+template<typename I, class G>
+void normal_distribution<REAL>::generate( I first, I last, G & g ) const
+{
+	const detail::normal_ziggurat & z = detail::normal_ziggurat::instance();
+	for ( ; first != last; ++first )
+	{
+		*first = _mean + _stddev * result_type( z.generate( g ) );
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+template<typename REAL>
+exponential_distribution<REAL>::exponential_distribution( result_type lambda ) : _lambda( lambda )
+{
+}
+
+template<typename REAL>
+template<class G>
+typename exponential_distribution<REAL>::result_type exponential_distribution<REAL>::operator () ( G & g ) const
+{
+	return result_type( detail::exponential_ziggurat::instance().generate( g ) ) / _lambda;
+}
+
+template<typename REAL>
+template<typename I, class G>
+void exponential_distribution<REAL>::generate( I first, I last, G & g ) const
+{
+	const detail::exponential_ziggurat & z = detail::exponential_ziggurat::instance();
+	for ( ; first != last; ++first )
+	{
+		*first = result_type( z.generate( g ) ) / _lambda;
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+template<typename INT>
+discrete_distribution<INT>::discrete_distribution() : _block_size( 1 ), _weights( 1, 1.0 )
+{
+	_block_sum.assign( 1, 1.0 );
+	_prob.resize( 1 );
+	_alias.resize( 1 );
+	build_block( 0 );
+}
+
+template<typename INT>
+template<typename I>
+discrete_distribution<INT>::discrete_distribution( I first, I last, std::size_t block_size ) : _block_size( block_size ), _weights( first, last )
+{
+	if ( _weights.empty() ) _weights.assign( 1, 1.0 );
+	if ( _block_size == 0 || _block_size > _weights.size() ) _block_size = _weights.size();
+
+	const std::size_t n = _weights.size();
+	const std::size_t blocks = ( n + _block_size - 1 ) / _block_size;
+
+	_prob.resize( n );
+	_alias.resize( n );
+	_block_sum.assign( blocks, 0.0 );
+	for ( std::size_t i = 0; i < n; ++i )
+	{
+		_block_sum[i / _block_size] += _weights[i];
+	}
+	for ( std::size_t b = 0; b < blocks; ++b )
+	{
+		build_block( b );
+	}
+	build_top();
+}
+
+template<typename INT>
+template<class G>
+typename discrete_distribution<INT>::result_type discrete_distribution<INT>::operator () ( G & g ) const
+{
+	if ( _block_sum.size() == 1 )
+	{
+		return result_type( sample( &_prob[0], &_alias[0], uint32_t( _weights.size() ), 0, g ) );
+	}
+
+	const uint32_t b      = sample( &_block_prob[0], &_block_alias[0], uint32_t( _block_sum.size() ), 0, g );
+	const uint32_t offset = uint32_t( b * _block_size );
+	const uint32_t n      = uint32_t( std::min( _block_size, _weights.size() - offset ) );
+	return result_type( sample( &_prob[offset], &_alias[offset], n, offset, g ) );
+}
+
+template<typename INT>
+template<typename I, class G>
+void discrete_distribution<INT>::generate( I first, I last, G & g ) const
+{
+	for ( ; first != last; ++first )
+	{
+		*first = (*this)( g );
+	}
+}
+
+template<typename INT>
+void discrete_distribution<INT>::update( std::size_t i, double weight )
+{
+	const std::size_t b     = i / _block_size;
+	const std::size_t begin = b * _block_size;
+	const std::size_t end   = std::min( begin + _block_size, _weights.size() );
+
+	_weights[i] = weight;
+
+	// Sum again rather than adjusting by the difference, so that rounding
+	// errors do not accumulate over many updates.
+	double sum = 0.0;
+	for ( std::size_t j = begin; j < end; ++j )
+	{
+		sum += _weights[j];
+	}
+	_block_sum[b] = sum;
+
+	build_block( b );
+	build_top();
+}
+
+template<typename INT>
+std::vector<double> discrete_distribution<INT>::probabilities() const
+{
+	double sum = 0.0;
+	for ( std::size_t b = 0; b < _block_sum.size(); ++b )
+	{
+		sum += _block_sum[b];
+	}
+
+	std::vector<double> p( _weights.size() );
+	for ( std::size_t i = 0; i < p.size(); ++i )
+	{
+		p[i] = ( sum > 0.0 ) ? _weights[i] / sum : 1.0 / p.size();
+	}
+	return p;
+}
+
+template<typename INT>
+void discrete_distribution<INT>::build_block( std::size_t b )
+{
+	const std::size_t begin = b * _block_size;
+	const std::size_t n     = std::min( _block_size, _weights.size() - begin );
+	build( &_weights[begin], n, _block_sum[b], &_prob[begin], &_alias[begin], uint32_t( begin ) );
+}
+
+template<typename INT>
+void discrete_distribution<INT>::build_top()
+{
+	const std::size_t blocks = _block_sum.size();
+	if ( blocks == 1 ) return;
+
+	double sum = 0.0;
+	for ( std::size_t b = 0; b < blocks; ++b )
+	{
+		sum += _block_sum[b];
+	}
+	_block_prob.resize( blocks );
+	_block_alias.resize( blocks );
+	build( &_block_sum[0], blocks, sum, &_block_prob[0], &_block_alias[0], 0 );
+}
+
+template<typename INT>
+void discrete_distribution<INT>::build( const double * weights, std::size_t n, double sum,
+	uint32_t * prob, uint32_t * alias, uint32_t offset )
+{
+	// Column i keeps its own index with probability prob[i] / 2^32,
+	// otherwise it yields alias[i]. Full columns alias to themselves.
+	for ( std::size_t i = 0; i < n; ++i )
+	{
+		prob[i]  = 0xffffffffu;
+		alias[i] = offset + uint32_t( i );
+	}
+	if ( !( sum > 0.0 ) ) return;
+
+	std::vector<double>   p( n );
+	std::vector<uint32_t> small, large;
+	small.reserve( n );
+	large.reserve( n );
+
+	for ( std::size_t i = 0; i < n; ++i )
+	{
+		p[i] = weights[i] * n / sum;
+		( p[i] < 1.0 ? small : large ).push_back( uint32_t( i ) );
+	}
+
+	while ( !small.empty() && !large.empty() )
+	{
+		const uint32_t s = small.back();
+		const uint32_t l = large.back();
+		small.pop_back();
+
+		prob[s]  = uint32_t( p[s] * 4294967296.0 );
+		alias[s] = offset + l;
+
+		p[l] = ( p[l] + p[s] ) - 1.0;
+		if ( p[l] < 1.0 )
+		{
+			large.pop_back();
+			small.push_back( l );
+		}
+	}
+	// Remaining columns are full up to rounding errors, and keep the default.
+}
+
+template<typename INT>
+template<class G>
+uint32_t discrete_distribution<INT>::sample( const uint32_t * prob, const uint32_t * alias, uint32_t n, uint32_t offset, G & g )
+{
+	const uint32_t j = uniform_int_distribution<uint32_t>( 0, n - 1 )( g );
+	return ( detail::generate_word32( g ) < prob[j] ) ? offset + j : alias[j];
+}
+
 }
 
 #endif
@@ -0,0 +1,321 @@
+/*
+	Copyright (c) 2012 Charly LERSTEAU
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef OT_REPLICA_EXCHANGE_HPP
+#define OT_REPLICA_EXCHANGE_HPP
+
+#if !( __cplusplus > 201100L || __GXX_EXPERIMENTAL_CXX0X__ )
+#error "replica_exchange.hpp requires C++11."
+#endif
+
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+#include <stdint.h>
+#include <utility>
+#include <vector>
+#include "function.hpp"
+#include "incremental.hpp"
+#include "random.hpp"
+#include "thread_pool.hpp"
+
+namespace ot
+{
+
+/*
+	Class: replica_exchange<Model, Move, E>
+
+	Parallel tempering: simulated annealing chains, the replicas, run at a
+	fixed ladder of temperatures and exchange their solutions, minimizing.
+
+	The model is an <incremental_state> model, so that each move costs a
+	delta evaluation; neighbor(x, g) draws a random move of the solution x.
+
+	A round is made of:
+		- a sweep, in which each replica makes a number of moves on its own
+		  state and its own engine; the replicas run in parallel on a
+		  thread pool and share nothing during a sweep,
+		- a synchronized exchange step, in which pairs of adjacent
+		  temperatures (even pairs on even rounds, odd pairs on odd rounds)
+		  exchange their replicas with the Metropolis probability
+		  min(1, exp((1/Ti - 1/Tj)(Ei - Ej))). Only the indices of the
+		  replicas are exchanged, never the solutions.
+
+	Acceptance tests are batched: the uniforms of a batch of moves are
+	drawn in bulk and compared to a polynomial approximation of exp()
+	(relative error below 2e-7 above -708, 0 below), which costs a fraction
+	of std::exp().
+
+	Engine i of an <engine_pool> seeded with the given seed drives replica
+	i, and the last engine the exchange steps, so that a run only depends
+	on the seed and not on the number of threads.
+*/
+
+template<class Model, class Move, class E = mt19937>
+class replica_exchange
+{
+public:
+	typedef Model                         model_type;
+	typedef Move                          move_type;
+	typedef E                             engine_type;
+	typedef typename Model::solution_type solution_type;
+	typedef typename Model::value_type    value_type;
+
+	typedef function<Move(const solution_type &, E &)> neighbor_type;
+
+	static const std::size_t batch_size = 64;
+
+	replica_exchange( const Model & model, const solution_type & x, neighbor_type neighbor, const std::vector<double> & temperatures, uint64_t seed = 0 );
+
+	void run( std::size_t rounds, std::size_t sweep );
+	void run( thread_pool & pool, std::size_t rounds, std::size_t sweep );
+
+	std::size_t size() const { return _temperatures.size(); }
+	double temperature( std::size_t t ) const { return _temperatures[t]; }
+
+	const solution_type & solution( std::size_t t ) const { return _replicas[_slot[t]].state.solution(); }
+	value_type value( std::size_t t ) const { return _replicas[_slot[t]].state.value(); }
+
+	const solution_type & best() const;
+	value_type best_value() const;
+
+	double acceptance_rate( std::size_t t ) const;
+	double exchange_rate( std::size_t t ) const;
+
+	static std::vector<double> geometric_temperatures( double t_min, double t_max, std::size_t n );
+
+private:
+	struct replica
+	{
+		incremental_state<Model> state;
+		solution_type            best;
+		value_type               best_value;
+
+		replica( const Model & model, const solution_type & x ) : state( model, x ), best( x ), best_value( state.value() ) {}
+	};
+
+	void sweep( std::size_t t, std::size_t moves );
+	void exchange();
+
+	neighbor_type             _neighbor;
+	std::vector<double>       _temperatures;
+	std::vector<replica>      _replicas;
+	std::vector<std::size_t>  _slot;    // Replica at each temperature.
+	engine_pool<E>            _engines;
+	std::size_t               _round;
+
+	std::vector<uint64_t>     _proposed;
+	std::vector<uint64_t>     _accepted;
+	std::vector<uint64_t>     _exchanges_proposed;
+	std::vector<uint64_t>     _exchanges_accepted;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace detail
+{
+
+// exp(x) for x <= 0 in a few multiplications: x = (n + f) ln 2 with
+// |f| <= 1/2, 2^f by a degree-6 polynomial, 2^n written in the exponent.
+// n is rounded by an integer conversion, which avoids a call to floor()
+// and, unlike the addition of 1.5 * 2^52, survives -ffast-math.
+inline double fast_exp( double x )
+{
+	if ( !( x > -708.0 ) ) return 0.0;
+
+	const double y = x * 1.4426950408889634;
+	const int64_t n = int64_t( y - 0.5 ); // Rounded to nearest, for y <= 0.
+	const double f = y - double( n );
+
+	const double p = 1.0 + f * ( 0.6931471805599453 + f * ( 0.2402265069591007 + f * ( 0.05550410866482158
+		+ f * ( 0.009618129107628477 + f * ( 0.0013333558146428443 + f * 0.00015403530393381606 ) ) ) ) );
+
+	const uint64_t bits = uint64_t( n + 1023 ) << 52;
+	double s;
+	std::memcpy( &s, &bits, sizeof( s ) );
+	return p * s;
+}
+
+}
+
+template<class Model, class Move, class E>
+replica_exchange<Model, Move, E>::replica_exchange( const Model & model, const solution_type & x, neighbor_type neighbor, const std::vector<double> & temperatures, uint64_t seed )
+	: _neighbor( std::move( neighbor ) ), _temperatures( temperatures ), _engines( temperatures.size() + 1, seed ), _round( 0 ),
+	  _proposed( temperatures.size(), 0 ), _accepted( temperatures.size(), 0 ),
+	  _exchanges_proposed( temperatures.size(), 0 ), _exchanges_accepted( temperatures.size(), 0 )
+{
+	_replicas.reserve( size() );
+	for ( std::size_t t = 0; t < size(); ++t )
+	{
+		_replicas.push_back( replica( model, x ) );
+		_slot.push_back( t );
+	}
+}
+
+template<class Model, class Move, class E>
+void replica_exchange<Model, Move, E>::run( std::size_t rounds, std::size_t moves )
+{
+	for ( std::size_t r = 0; r < rounds; ++r )
+	{
+		for ( std::size_t t = 0; t < size(); ++t ) sweep( t, moves );
+		exchange();
+	}
+}
+
+template<class Model, class Move, class E>
+void replica_exchange<Model, Move, E>::run( thread_pool & pool, std::size_t rounds, std::size_t moves )
+{
+	for ( std::size_t r = 0; r < rounds; ++r )
+	{
+		pool.parallel_for( std::size_t( 0 ), size(), [this, moves] ( std::size_t first, std::size_t last )
+		{
+			for ( std::size_t t = first; t < last; ++t ) sweep( t, moves );
+		}, 1 );
+		exchange();
+	}
+}
+
+template<class Model, class Move, class E>
+void replica_exchange<Model, Move, E>::sweep( std::size_t t, std::size_t moves )
+{
+	const std::size_t i = _slot[t];
+	replica & rep = _replicas[i];
+	E & g = _engines[i];
+	const double beta = 1.0 / _temperatures[t];
+	const uniform_real_distribution<double> uniform;
+
+	double u[batch_size];
+	uint64_t accepted = 0;
+
+	for ( std::size_t done = 0; done < moves; )
+	{
+		const std::size_t n = moves - done < batch_size ? moves - done : batch_size;
+		uniform.generate( u, u + n, g );
+
+		for ( std::size_t k = 0; k < n; ++k )
+		{
+			const Move m = _neighbor( rep.state.solution(), g );
+			const value_type v = rep.state.evaluate_move( m );
+			const double delta = double( v - rep.state.value() );
+
+			if ( delta <= 0.0 || u[k] < detail::fast_exp( -beta * delta ) )
+			{
+				rep.state.apply( m, v );
+				++accepted;
+				if ( v < rep.best_value )
+				{
+					rep.best       = rep.state.solution();
+					rep.best_value = v;
+				}
+			}
+		}
+		done += n;
+	}
+
+	_proposed[t] += moves;
+	_accepted[t] += accepted;
+}
+
+template<class Model, class Move, class E>
+void replica_exchange<Model, Move, E>::exchange()
+{
+	E & g = _engines[size()];
+	const uniform_real_distribution<double> uniform;
+
+	for ( std::size_t t = _round % 2; t + 1 < size(); t += 2 )
+	{
+		const double d = ( 1.0 / _temperatures[t] - 1.0 / _temperatures[t + 1] )
+		               * double( value( t ) - value( t + 1 ) );
+
+		++_exchanges_proposed[t];
+		if ( d >= 0.0 || uniform( g ) < detail::fast_exp( d ) )
+		{
+			std::swap( _slot[t], _slot[t + 1] );
+			++_exchanges_accepted[t];
+		}
+	}
+	++_round;
+}
+
+template<class Model, class Move, class E>
+const typename replica_exchange<Model, Move, E>::solution_type & replica_exchange<Model, Move, E>::best() const
+{
+	std::size_t b = 0;
+	for ( std::size_t i = 1; i < _replicas.size(); ++i )
+	{
+		if ( _replicas[i].best_value < _replicas[b].best_value ) b = i;
+	}
+	return _replicas[b].best;
+}
+
+template<class Model, class Move, class E>
+typename replica_exchange<Model, Move, E>::value_type replica_exchange<Model, Move, E>::best_value() const
+{
+	value_type v = _replicas[0].best_value;
+	for ( std::size_t i = 1; i < _replicas.size(); ++i )
+	{
+		if ( _replicas[i].best_value < v ) v = _replicas[i].best_value;
+	}
+	return v;
+}
+
+/*
+	Method: acceptance_rate
+
+	Ratio of accepted moves at temperature t.
+*/
+
+template<class Model, class Move, class E>
+double replica_exchange<Model, Move, E>::acceptance_rate( std::size_t t ) const
+{
+	return _proposed[t] == 0 ? 0.0 : double( _accepted[t] ) / double( _proposed[t] );
+}
+
+/*
+	Method: exchange_rate
+
+	Ratio of accepted exchanges between temperatures t and t + 1, which
+	should not be too low for solutions to travel along the ladder.
+*/
+
+template<class Model, class Move, class E>
+double replica_exchange<Model, Move, E>::exchange_rate( std::size_t t ) const
+{
+	return _exchanges_proposed[t] == 0 ? 0.0 : double( _exchanges_accepted[t] ) / double( _exchanges_proposed[t] );
+}
+
+/*
+	Method: geometric_temperatures
+
+	n temperatures from t_min to t_max in geometric progression, the usual
+	ladder when the heat capacity is roughly constant.
+*/
+
+template<class Model, class Move, class E>
+std::vector<double> replica_exchange<Model, Move, E>::geometric_temperatures( double t_min, double t_max, std::size_t n )
+{
+	std::vector<double> t( n, t_min );
+	for ( std::size_t i = 1; i < n; ++i )
+	{
+		t[i] = t_min * std::pow( t_max / t_min, double( i ) / double( n - 1 ) );
+	}
+	return t;
+}
+
+}
+
+#endif
@@ -0,0 +1,277 @@
+/*
+	Copyright (c) 2012 Charly LERSTEAU
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef OT_SCALARIZATION_HPP
+#define OT_SCALARIZATION_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+namespace ot
+{
+
+/*
+	About: Scalarization
+
+	Functors which reduce an objective vector to a value to minimize, as in
+	decomposition-based algorithms such as MOEA/D. They accept any vector
+	with size() and operator [], including the rows of a population, and
+	serve as keys of <sort_by_key>, <partial_sort_by_key> and
+	<nth_element_by_key>.
+
+	For many weight vectors against many points, <weighted_sum_batch> and
+	<tchebycheff_batch> compute all the values in loops that vectorize.
+
+	See:
+		Q. Zhang, H. Li, MOEA/D: A Multiobjective Evolutionary Algorithm Based on Decomposition, 2007.
+*/
+
+/*
+	Class: weighted_sum<T>
+
+	sum( w[i] f[i] ).
+*/
+
+template<typename T = double>
+class weighted_sum
+{
+public:
+	typedef T result_type;
+
+	template<typename I>
+	weighted_sum( I first, I last ) : _weights( first, last ) {}
+
+	template<class V>
+	T operator () ( const V & f ) const
+	{
+		T s = T();
+		for ( std::size_t i = 0; i < _weights.size(); ++i ) s += _weights[i] * f[i];
+		return s;
+	}
+
+	const std::vector<T> & weights() const { return _weights; }
+
+private:
+	std::vector<T> _weights;
+};
+
+/*
+	Class: tchebycheff<T>
+
+	Weighted Tchebycheff distance to a reference point z, usually the ideal
+	point: max( w[i] |f[i] - z[i]| ), plus rho sum( w[i] |f[i] - z[i]| ) in
+	the augmented version, whose optima are all Pareto optimal.
+*/
+
+template<typename T = double>
+class tchebycheff
+{
+public:
+	typedef T result_type;
+
+	template<typename I1, typename I2>
+	tchebycheff( I1 first, I1 last, I2 reference, T rho = T() ) : _weights( first, last ), _reference( reference, reference + ( last - first ) ), _rho( rho ) {}
+
+	template<class V>
+	T operator () ( const V & f ) const
+	{
+		T m = T(), s = T();
+		for ( std::size_t i = 0; i < _weights.size(); ++i )
+		{
+			const T d = _weights[i] * std::abs( f[i] - _reference[i] );
+			if ( m < d ) m = d;
+			s += d;
+		}
+		return m + _rho * s;
+	}
+
+	/*
+		Method: update_reference
+
+		Lowers the reference point to include f, as MOEA/D does with the ideal point.
+	*/
+
+	template<class V>
+	void update_reference( const V & f )
+	{
+		for ( std::size_t i = 0; i < _reference.size(); ++i )
+		{
+			if ( f[i] < _reference[i] ) _reference[i] = f[i];
+		}
+	}
+
+	const std::vector<T> & weights() const { return _weights; }
+	const std::vector<T> & reference() const { return _reference; }
+
+private:
+	std::vector<T> _weights;
+	std::vector<T> _reference;
+	T              _rho;
+};
+
+/*
+	Class: lexicographic_less<T>
+
+	Lexicographic order of objective vectors, optionally with the objectives
+	taken in a given order of priority. Comparisons are cheap, so it is used
+	directly as the comparator of std::sort.
+*/
+
+template<typename T = double>
+class lexicographic_less
+{
+public:
+	typedef bool result_type;
+
+	lexicographic_less() {}
+
+	template<typename I>
+	lexicographic_less( I first, I last ) : _order( first, last ) {}
+
+	template<class V>
+	bool operator () ( const V & a, const V & b ) const
+	{
+		const std::size_t n = _order.empty() ? a.size() : _order.size();
+		for ( std::size_t k = 0; k < n; ++k )
+		{
+			const std::size_t i = _order.empty() ? k : _order[k];
+			if ( a[i] < b[i] ) return true;
+			if ( b[i] < a[i] ) return false;
+		}
+		return false;
+	}
+
+private:
+	std::vector<std::size_t> _order;
+};
+
+/*
+	Function: weighted_sum_batch
+
+	Weighted sums of n points against k weight vectors of m objectives, both
+	stored row by row (as in a population): out[i * n + j] is the value of
+	point j for weight vector i.
+*/
+
+template<typename T>
+void weighted_sum_batch( const T * weights, std::size_t k, const T * points, std::size_t n, std::size_t m, T * out );
+
+/*
+	Function: tchebycheff_batch
+
+	Tchebycheff values of n points against k weight vectors and a reference
+	point, laid out as in <weighted_sum_batch>, augmented by rho as in
+	<tchebycheff>.
+*/
+
+template<typename T>
+void tchebycheff_batch( const T * weights, std::size_t k, const T * reference, const T * points, std::size_t n, std::size_t m, T * out, T rho = T() );
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace detail
+{
+
+// Points are processed in tiles, transposed so that the inner loops run
+// over contiguous values of one objective.
+const std::size_t scalarization_tile = 256;
+
+template<typename T>
+std::size_t transpose_tile( const T * points, std::size_t n, std::size_t m, std::size_t first, std::vector<T> & tile )
+{
+	const std::size_t size = ( first + scalarization_tile < n ) ? scalarization_tile : n - first;
+	tile.resize( m * scalarization_tile );
+	for ( std::size_t j = 0; j < size; ++j )
+	{
+		for ( std::size_t l = 0; l < m; ++l ) tile[l * scalarization_tile + j] = points[( first + j ) * m + l];
+	}
+	return size;
+}
+
+}
+
+template<typename T>
+void weighted_sum_batch( const T * weights, std::size_t k, const T * points, std::size_t n, std::size_t m, T * out )
+{
+	std::vector<T> tile;
+	for ( std::size_t first = 0; first < n; first += detail::scalarization_tile )
+	{
+		const std::size_t size = detail::transpose_tile( points, n, m, first, tile );
+		for ( std::size_t i = 0; i < k; ++i )
+		{
+			T * o = out + i * n + first;
+			for ( std::size_t j = 0; j < size; ++j ) o[j] = T();
+			for ( std::size_t l = 0; l < m; ++l )
+			{
+				const T w = weights[i * m + l];
+				const T * p = &tile[l * detail::scalarization_tile];
+				for ( std::size_t j = 0; j < size; ++j ) o[j] += w * p[j];
+			}
+		}
+	}
+}
+
+template<typename T>
+void tchebycheff_batch( const T * weights, std::size_t k, const T * reference, const T * points, std::size_t n, std::size_t m, T * out, T rho )
+{
+	const bool augmented = rho != T();
+	std::vector<T> tile;
+	std::vector<T> sums( augmented ? detail::scalarization_tile : 0 );
+	for ( std::size_t first = 0; first < n; first += detail::scalarization_tile )
+	{
+		const std::size_t size = detail::transpose_tile( points, n, m, first, tile );
+		for ( std::size_t i = 0; i < k; ++i )
+		{
+			T * o = out + i * n + first;
+			for ( std::size_t j = 0; j < size; ++j ) o[j] = T();
+			if ( augmented ) std::fill( sums.begin(), sums.begin() + size, T() );
+			for ( std::size_t l = 0; l < m; ++l )
+			{
+				const T w = weights[i * m + l];
+				const T z = reference[l];
+				const T * p = &tile[l * detail::scalarization_tile];
+				if ( augmented )
+				{
+					for ( std::size_t j = 0; j < size; ++j )
+					{
+						const T d = w * std::abs( p[j] - z );
+						o[j] = ( o[j] < d ) ? d : o[j];
+						sums[j] += d;
+					}
+				}
+				else
+				{
+					for ( std::size_t j = 0; j < size; ++j )
+					{
+						const T d = w * std::abs( p[j] - z );
+						o[j] = ( o[j] < d ) ? d : o[j];
+					}
+				}
+			}
+			if ( augmented )
+			{
+				for ( std::size_t j = 0; j < size; ++j ) o[j] += rho * sums[j];
+			}
+		}
+	}
+}
+
+}
+
+#endif
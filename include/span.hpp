@@ -0,0 +1,144 @@
+/*
+	Copyright (c) 2012 Charly LERSTEAU
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef OT_SPAN_HPP
+#define OT_SPAN_HPP
+
+#include <cstddef>
+#include <valarray>
+#include <vector>
+
+#if __cplusplus > 201100L || __GXX_EXPERIMENTAL_CXX0X__
+#include <type_traits>
+#include <utility>
+#endif
+
+namespace ot
+{
+
+template<typename T>
+class span;
+
+namespace detail
+{
+
+template<bool B, typename T = void>
+struct span_enable_if {};
+
+template<typename T>
+struct span_enable_if<true, T> { typedef T type; };
+
+// Checks if U * converts to T *, so that U may be viewed as T.
+template<typename U, typename T>
+struct span_convertible
+{
+	static char test( T * );
+	static long test( ... );
+	static const bool value = sizeof( test( static_cast<U *>( 0 ) ) ) == sizeof( char );
+};
+
+#if __cplusplus > 201100L || __GXX_EXPERIMENTAL_CXX0X__
+
+template<class C>
+struct is_span : std::false_type {};
+
+template<typename U>
+struct is_span< span<U> > : std::true_type {};
+
+// Containers with data() convertible to T * and size(), other than spans.
+template<class C, typename T, typename = void>
+struct span_compatible : std::false_type {};
+
+template<class C, typename T>
+struct span_compatible<C, T, typename std::enable_if<
+	std::is_convertible<decltype( std::declval<C &>().data() ), T *>::value &&
+	std::is_convertible<decltype( std::declval<C &>().size() ), std::size_t>::value>::type>
+	: std::integral_constant<bool, !is_span<typename std::remove_cv<C>::type>::value> {};
+
+#endif
+
+}
+
+/*
+	Class: span<T>
+
+	(C++20) Non-owning view of a contiguous sequence of elements, such as
+	an array, a std::vector or a std::valarray.
+*/
+
+template<typename T>
+class span
+{
+public:
+	typedef T           element_type;
+	typedef T           value_type;
+	typedef T *         pointer;
+	typedef T &         reference;
+	typedef T *         iterator;
+	typedef std::size_t size_type;
+
+	span() : _data( 0 ), _size( 0 ) {}
+	span( T * data, std::size_t size ) : _data( data ), _size( size ) {}
+	span( T * first, T * last ) : _data( first ), _size( std::size_t( last - first ) ) {}
+
+	template<std::size_t N>
+	span( T ( &a )[N] ) : _data( a ), _size( N ) {}
+
+	// Spans of non-const elements, and contiguous containers whose elements
+	// convert to T.
+	template<typename U>
+	span( const span<U> & s, typename detail::span_enable_if<detail::span_convertible<U, T>::value>::type * = 0 ) : _data( s.data() ), _size( s.size() ) {}
+
+	template<typename U, class A>
+	span( std::vector<U, A> & v, typename detail::span_enable_if<detail::span_convertible<U, T>::value>::type * = 0 ) : _data( v.empty() ? 0 : &v[0] ), _size( v.size() ) {}
+
+	template<typename U, class A>
+	span( const std::vector<U, A> & v, typename detail::span_enable_if<detail::span_convertible<const U, T>::value>::type * = 0 ) : _data( v.empty() ? 0 : &v[0] ), _size( v.size() ) {}
+
+	template<typename U>
+	span( std::valarray<U> & v, typename detail::span_enable_if<detail::span_convertible<U, T>::value>::type * = 0 ) : _data( v.size() > 0 ? &v[0] : 0 ), _size( v.size() ) {}
+
+	template<typename U>
+	span( const std::valarray<U> & v, typename detail::span_enable_if<detail::span_convertible<const U, T>::value>::type * = 0 ) : _data( v.size() > 0 ? &v[0] : 0 ), _size( v.size() ) {}
+
+#if __cplusplus > 201100L || __GXX_EXPERIMENTAL_CXX0X__
+	// Other containers with data() and size(), such as std::array.
+	template<class C, typename = typename std::enable_if<detail::span_compatible<C, T>::value>::type>
+	span( C & c ) : _data( c.data() ), _size( c.size() ) {}
+#endif
+
+	T * data() const { return _data; }
+	std::size_t size() const { return _size; }
+	bool empty() const { return _size == 0; }
+
+	T * begin() const { return _data; }
+	T * end() const { return _data + _size; }
+
+	T & operator [] ( std::size_t i ) const { return _data[i]; }
+
+	span first( std::size_t n ) const { return span( _data, n ); }
+	span last( std::size_t n ) const { return span( _data + _size - n, n ); }
+	span subspan( std::size_t offset, std::size_t n ) const { return span( _data + offset, n ); }
+
+private:
+	T *         _data;
+	std::size_t _size;
+};
+
+}
+
+#endif
@@ -0,0 +1,494 @@
+/*
+	Copyright (c) 2012 Charly LERSTEAU
+
+	This program is free software: you can redistribute it and/or modify
+	it under the terms of the GNU General Public License as published by
+	the Free Software Foundation, either version 3 of the License, or
+	(at your option) any later version.
+
+	This program is distributed in the hope that it will be useful,
+	but WITHOUT ANY WARRANTY; without even the implied warranty of
+	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+	GNU General Public License for more details.
+
+	You should have received a copy of the GNU General Public License
+	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef OT_THREAD_POOL_HPP
+#define OT_THREAD_POOL_HPP
+
+#if !( __cplusplus > 201100L || __GXX_EXPERIMENTAL_CXX0X__ )
+#error "thread_pool.hpp requires C++11."
+#endif
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "function.hpp"
+
+#if defined( __linux__ )
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace ot
+{
+
+/*
+	Class: thread_pool
+
+	Work-stealing thread pool, the parallel backend of the library.
+
+	Each worker owns a deque of tasks: it pops its own tasks from the back
+	and steals from the front of the others when it runs out. Tasks
+	submitted from a worker go to its own deque, other tasks are dealt
+	round-robin.
+
+	<parallel_for> and <parallel_reduce> are fork-join: the range is split
+	in halves recursively, one half being pushed for the others to steal,
+	so that large pieces are stolen first. A thread waiting for a
+	<task_group> runs pending tasks meanwhile, then sleeps. Parallel calls
+	nested in tasks therefore use the same workers instead of starting new
+	threads, and do not deadlock.
+
+	The concurrency of the pool includes the calling thread: a pool of
+	size n starts n-1 workers, optionally pinned to distinct CPUs among
+	those the process may use (Linux); <pinned> tells if pinning succeeded.
+	Tasks given to <submit> should not throw.
+*/
+
+class thread_pool
+{
+public:
+	typedef function<void()> task_type;
+
+	explicit thread_pool( std::size_t threads = 0, bool pin = false );
+	~thread_pool();
+
+	std::size_t size() const { return _count + 1; }
+	bool pinned() const { return _pinned; }
+
+	void submit( task_type task );
+	bool run_pending_task();
+
+	template<typename INT, class F>
+	void parallel_for( INT first, INT last, F f, std::size_t chunk = 0 );
+
+	template<typename INT, typename T, class M, class R>
+	T parallel_reduce( INT first, INT last, T init, M map, R reduce, std::size_t chunk = 0 );
+
+private:
+	friend class task_group;
+
+	thread_pool( const thread_pool & );
+	thread_pool & operator = ( const thread_pool & );
+
+	struct worker
+	{
+		std::mutex            mutex;
+		std::deque<task_type> tasks;
+		char                  padding[64]; // Against false sharing between deques.
+	};
+
+	struct current_worker
+	{
+		thread_pool * pool;
+		std::size_t   index;
+	};
+
+	static current_worker & current();
+
+	void run( std::size_t i );
+	bool pop( std::size_t i, task_type & task );
+	void wait( const std::atomic<std::size_t> & counter );
+	void notify_all();
+	std::size_t default_chunk( std::size_t n ) const;
+
+	std::size_t                _count;
+	std::unique_ptr<worker[]>  _workers;
+	std::vector<std::thread>   _threads;
+	std::mutex                 _mutex;
+	std::condition_variable    _ready;
+	std::atomic<std::size_t>   _pending;
+	std::atomic<std::size_t>   _next;
+	bool                       _stop;
+	bool                       _pinned;
+};
+
+/*
+	Class: task_group
+
+	Set of tasks run by a thread pool, which <wait> joins. The first
+	exception thrown by a task is rethrown by <wait>. The destructor waits
+	for the tasks, without rethrowing.
+*/
+
+class task_group
+{
+public:
+	explicit task_group( thread_pool & pool ) : _pool( pool ), _pending( 0 ) {}
+	~task_group();
+
+	template<class F>
+	void run( F f );
+
+	void wait();
+
+	thread_pool & pool() const { return _pool; }
+
+private:
+	task_group( const task_group & );
+	task_group & operator = ( const task_group & );
+
+	template<class F>
+	struct task
+	{
+		task_group * group;
+		F            f;
+
+		void operator () ()
+		{
+			try
+			{
+				f();
+			}
+			catch ( ... )
+			{
+				std::lock_guard<std::mutex> lock( group->_mutex );
+				if ( !group->_error ) group->_error = std::current_exception();
+			}
+			// The group may be destroyed as soon as the counter is zero.
+			thread_pool & pool = group->_pool;
+			if ( --group->_pending == 0 ) pool.notify_all();
+		}
+	};
+
+	thread_pool &            _pool;
+	std::atomic<std::size_t> _pending;
+	std::mutex               _mutex;
+	std::exception_ptr       _error;
+};
+
+/*
+	Function: default_thread_pool
+
+	Pool shared by the whole program, with one thread per core.
+*/
+
+inline thread_pool & default_thread_pool()
+{
+	static thread_pool pool;
+	return pool;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+inline thread_pool::thread_pool( std::size_t threads, bool pin ) : _count( 0 ), _pending( 0 ), _next( 0 ), _stop( false ), _pinned( false )
+{
+	const std::size_t cores = std::thread::hardware_concurrency();
+	if ( threads == 0 ) threads = cores;
+	if ( threads == 0 ) threads = 1;
+
+	_count = threads - 1;
+	_workers.reset( new worker[_count > 0 ? _count : 1] );
+	_threads.reserve( _count );
+	for ( std::size_t i = 0; i < _count; ++i )
+	{
+		_threads.push_back( std::thread( &thread_pool::run, this, i ) );
+	}
+
+#if defined( __linux__ )
+	// CPUs the process may use (taskset, cgroups), in order; worker i goes
+	// on the (i+1)-th, leaving the first to the calling thread.
+	cpu_set_t allowed;
+	CPU_ZERO( &allowed );
+	if ( pin && _count > 0 && sched_getaffinity( 0, sizeof( allowed ), &allowed ) == 0 )
+	{
+		std::vector<int> cpus;
+		for ( int c = 0; c < CPU_SETSIZE; ++c )
+		{
+			if ( CPU_ISSET( c, &allowed ) ) cpus.push_back( c );
+		}
+
+		_pinned = !cpus.empty();
+		for ( std::size_t i = 0; i < _count && _pinned; ++i )
+		{
+			cpu_set_t set;
+			CPU_ZERO( &set );
+			CPU_SET( cpus[( i + 1 ) % cpus.size()], &set );
+			_pinned = pthread_setaffinity_np( _threads[i].native_handle(), sizeof( set ), &set ) == 0;
+		}
+	}
+#else
+	(void) pin;
+#endif
+}
+
+inline thread_pool::~thread_pool()
+{
+	{
+		std::lock_guard<std::mutex> lock( _mutex );
+		_stop = true;
+	}
+	_ready.notify_all();
+	for ( std::size_t i = 0; i < _threads.size(); ++i ) _threads[i].join();
+}
+
+inline thread_pool::current_worker & thread_pool::current()
+{
+	static thread_local current_worker w = { 0, 0 };
+	return w;
+}
+
+inline void thread_pool::submit( task_type task )
+{
+	if ( _count == 0 )
+	{
+		task();
+		return;
+	}
+
+	const current_worker & w = current();
+	const std::size_t i = ( w.pool == this ) ? w.index : _next++ % _count;
+
+	// Counted before the push, so that a thief decrements after it.
+	{
+		std::lock_guard<std::mutex> lock( _mutex );
+		++_pending;
+	}
+	{
+		std::lock_guard<std::mutex> lock( _workers[i].mutex );
+		_workers[i].tasks.push_back( std::move( task ) );
+	}
+	_ready.notify_one();
+}
+
+inline bool thread_pool::run_pending_task()
+{
+	const current_worker & w = current();
+	task_type task;
+	if ( !pop( ( w.pool == this ) ? w.index : _next % ( _count > 0 ? _count : 1 ), task ) ) return false;
+	task();
+	return true;
+}
+
+inline bool thread_pool::pop( std::size_t i, task_type & task )
+{
+	// Own deque first, from the back.
+	{
+		worker & w = _workers[i];
+		std::lock_guard<std::mutex> lock( w.mutex );
+		if ( !w.tasks.empty() )
+		{
+			task = std::move( w.tasks.back() );
+			w.tasks.pop_back();
+			--_pending;
+			return true;
+		}
+	}
+
+	// Then steal from the front of the others.
+	for ( std::size_t k = 1; k < _count; ++k )
+	{
+		worker & w = _workers[( i + k ) % _count];
+		std::lock_guard<std::mutex> lock( w.mutex );
+		if ( !w.tasks.empty() )
+		{
+			task = std::move( w.tasks.front() );
+			w.tasks.pop_front();
+			--_pending;
+			return true;
+		}
+	}
+	return false;
+}
+
+inline void thread_pool::run( std::size_t i )
+{
+	current_worker & w = current();
+	w.pool  = this;
+	w.index = i;
+
+	for ( ;; )
+	{
+		task_type task;
+		if ( pop( i, task ) )
+		{
+			task();
+			continue;
+		}
+
+		std::unique_lock<std::mutex> lock( _mutex );
+		_ready.wait( lock, [this] { return _stop || _pending > 0; } );
+		if ( _stop && _pending == 0 ) return;
+	}
+}
+
+// Runs pending tasks until the counter is zero, sleeping when there are
+// none until a task is submitted or the counter reaches zero. The last task
+// decrements the counter before notify_all(), which takes the mutex, so the
+// wakeup cannot be lost between the check and the wait.
+inline void thread_pool::wait( const std::atomic<std::size_t> & counter )
+{
+	while ( counter != 0 )
+	{
+		if ( run_pending_task() ) continue;
+
+		std::unique_lock<std::mutex> lock( _mutex );
+		_ready.wait( lock, [&] { return counter == 0 || _pending > 0; } );
+	}
+}
+
+inline void thread_pool::notify_all()
+{
+	{
+		std::lock_guard<std::mutex> lock( _mutex );
+	}
+	_ready.notify_all();
+}
+
+// About four chunks per thread.
+inline std::size_t thread_pool::default_chunk( std::size_t n ) const
+{
+	const std::size_t c = ( n + 4 * size() - 1 ) / ( 4 * size() );
+	return c > 0 ? c : 1;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+inline task_group::~task_group()
+{
+	_pool.wait( _pending );
+}
+
+template<class F>
+void task_group::run( F f )
+{
+	++_pending;
+	const task<F> t = { this, std::move( f ) };
+	_pool.submit( t );
+}
+
+inline void task_group::wait()
+{
+	_pool.wait( _pending );
+
+	std::exception_ptr e;
+	{
+		std::lock_guard<std::mutex> lock( _mutex );
+		std::swap( e, _error );
+	}
+	if ( e ) std::rethrow_exception( e );
+}
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace detail
+{
+
+template<typename INT, class F>
+struct parallel_for_context
+{
+	task_group & group;
+	F &          f;
+	std::size_t  chunk;
+};
+
+// Pushes the upper halves of [first, last) for the others to steal, down
+// to the chunk size, and runs the remaining chunk.
+template<typename INT, class F>
+struct parallel_for_task
+{
+	const parallel_for_context<INT, F> * context;
+	INT                                  first;
+	INT                                  last;
+
+	void operator () () const
+	{
+		INT b = first, e = last;
+		while ( std::size_t( e - b ) > context->chunk )
+		{
+			const INT m = INT( b + ( e - b ) / 2 );
+			const parallel_for_task t = { context, m, e };
+			context->group.run( t );
+			e = m;
+		}
+		context->f( b, e );
+	}
+};
+
+}
+
+/*
+	Method: parallel_for
+
+	Calls f( begin, end ) on chunks covering [first, last), and returns when
+	all chunks are done. The default chunk size gives about four chunks per
+	thread.
+*/
+
+template<typename INT, class F>
+void thread_pool::parallel_for( INT first, INT last, F f, std::size_t chunk )
+{
+	if ( !( first < last ) ) return;
+
+	const std::size_t n = std::size_t( last - first );
+	if ( chunk == 0 ) chunk = default_chunk( n );
+	if ( _count == 0 || chunk >= n )
+	{
+		f( first, last );
+		return;
+	}
+
+	task_group group( *this );
+	const detail::parallel_for_context<INT, F> context = { group, f, chunk };
+	const detail::parallel_for_task<INT, F> t = { &context, first, last };
+	group.run( t );
+	group.wait();
+}
+
+/*
+	Method: parallel_reduce
+
+	Reduces [first, last) with init: map( begin, end ) returns the value of
+	a chunk, and the values are combined from left to right with reduce.
+	The result only depends on the chunk size, which should be given for
+	reproducible floating-point results across pool sizes.
+*/
+
+template<typename INT, typename T, class M, class R>
+T thread_pool::parallel_reduce( INT first, INT last, T init, M map, R reduce, std::size_t chunk )
+{
+	if ( !( first < last ) ) return init;
+
+	const std::size_t n = std::size_t( last - first );
+	if ( chunk == 0 ) chunk = default_chunk( n );
+
+	const std::size_t chunks = ( n + chunk - 1 ) / chunk;
+	std::vector<T> partials( chunks );
+
+	parallel_for( std::size_t( 0 ), chunks, [&] ( std::size_t b, std::size_t e )
+	{
+		for ( std::size_t k = b; k < e; ++k )
+		{
+			const INT begin = INT( first + k * chunk );
+			const INT end   = ( k + 1 < chunks ) ? INT( begin + chunk ) : last;
+			partials[k] = map( begin, end );
+		}
+	}, 1 );
+
+	for ( std::size_t k = 0; k < chunks; ++k ) init = reduce( init, partials[k] );
+	return init;
+}
+
+}
+
+#endif